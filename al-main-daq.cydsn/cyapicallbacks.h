@@ -15,6 +15,8 @@
 
     /*Define your macro callbacks here */
     /*For more information, refer to the Writing Code topic in the PSoC Creator Help.*/
+    #define UART_Cmd_TXISR_EXIT_CALLBACK
+    void UART_Cmd_TXISR_ExitCallback(); //daq_cmd.c, feeds the UART_Cmd FIFO from buffCmdTx
 
     
 #endif /* CYAPICALLBACKS_H */   
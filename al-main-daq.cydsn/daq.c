@@ -0,0 +1,274 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Main loop of the Main PSOC DAQ, shared by the firmware main() and the host
+ * simulation so both run the same sequence of Check* routines. The routines
+ * are run to completion tasks, each pass runs those with work posted by the
+ * ISRs or other tasks, or whose deadline is up, and the CPU sleeps in between.
+ *
+ * ========================================
+*/
+
+#include "daq.h"
+
+uint8 cntError = 0;//count of general errors
+uint8 loopCount = 0;
+
+uint8 buffUsbTx[USBUART_BUFFER_SIZE]; //CDC IN packet, CheckFrameUSB builds each from the start and only once the endpoint is ready
+uint8 iBuffUsbTx = 0; //buffUsbTx / buffUsbTxDebug fill of the debug writes commented out in daq_bp.c and daq_frame.c
+uint8 buffUsbTxDebug[USBUART_BUFFER_SIZE];
+uint8 iBuffUsbTxDebug = 0;
+
+uint16 loopBudgetUs = LOOP_BUDGET_US; //pass time before the low priority tasks are put off, 0 never
+uint32 loopBudgetCycles = LOOP_BUDGET_US * (BCLK__BUS_CLK__HZ / 1000000u); //loopBudgetUs in TRACE_NOW cycles
+uint8 loopMaxDefer = LOOP_MAX_DEFER; //passes in a row the low priority tasks can be put off
+uint8 loopDeferred = 0; //passes in a row the low priority tasks were put off
+uint32 cntLoopYields = 0; //passes that put off the low priority tasks, since the last diagnostic packet
+volatile uint8 loopEvent[LOOP_EVENTS]; //TRUE when an ISR or a task posted work for the main loop tasks
+
+/**
+ * @brief Resets the indices of all the software buffers before the components are started
+ */
+void InitBuffers()
+{
+    buffEvRead = buffEvWrite = 0;
+    InitEventFramer();
+    InitBackplaneBuffers();
+	memset(buffUsbTx, 0, USBUART_BUFFER_SIZE);
+	memset(curBaroTempCnt, 0, (sizeof(uint32) * NUM_BARO));
+	memset(curBaroPresCnt, 0, (sizeof(uint32) * NUM_BARO));
+	memset(buffBaroCap, 0, (sizeof(uint16) * (NUM_BARO * NUM_BARO_CAPTURES)));
+	memset(buffBaroCapRead, 0, (NUM_BARO * 2));
+	memset((uint8 *)buffBaroCapWrite, 0, (NUM_BARO * 2));
+    memset(readBuffCmd, 0, COMMAND_SOURCES);
+    memset((uint8 *)writeBuffCmd, 0, COMMAND_SOURCES);
+    memset(headerBuffCmd, 0, COMMAND_SOURCES);
+    memset(interpretBuffCmd, 0, COMMAND_SOURCES);
+    memset((uint8 *)buffLRCmdRxRead, 0, LR_CMD_PORTS);
+    memset((uint8 *)buffLRCmdRxWrite, 0, LR_CMD_PORTS);
+    initCmdPos = NUMBER_INIT_CMDS;
+    memset((uint8 *)loopEvent, TRUE, LOOP_EVENTS); //every task runs on the first pass
+    
+    for (uint8 i = 0; i < COMMAND_SOURCES; i++)
+    {
+        commandStatusC[i] = WAIT_DLE;
+        orderBuffCmd[i] = i; //read the cmd buff in order
+    }
+}
+
+/**
+ * @brief Sets the main loop time budget
+ * @param budgetUs pass time in us before the low priority tasks are put off, 0 never puts them off
+ * @param maxDefer passes in a row they can be put off, then they run whatever the time
+ */
+void SetLoopBudget(uint16 budgetUs, uint8 maxDefer)
+{
+    loopBudgetUs = budgetUs;
+    loopBudgetCycles = (uint32)budgetUs * (BCLK__BUS_CLK__HZ / 1000000u);
+    loopMaxDefer = maxDefer;
+}
+
+/**
+ * @brief Checks if a low priority task still fits in the pass started at start
+ * @return uint8 TRUE to run it, FALSE to put it off to the next pass
+ */
+static uint8 LoopBudgetLeft(uint32 start)
+{
+    if ((0 == loopBudgetCycles) || (loopMaxDefer <= loopDeferred)) return TRUE;
+    return ((TRACE_NOW() - start) < loopBudgetCycles);
+}
+
+static int LoopEventPackets()
+{
+    uint32 traceStart = TRACE_START();
+    int tempRes = CheckEventPackets();
+    TRACE_END(TRACE_CHECK_EVENT, traceStart);
+    TraceOccupancy();
+    return tempRes;
+}
+
+static int LoopFrameBuffer()
+{
+    uint32 traceStart = TRACE_START();
+    int tempRes = CheckFrameBuffer();
+    TRACE_END(TRACE_CHECK_FRAME, traceStart);
+    return tempRes;
+}
+
+static int LoopHKBuffer()
+{
+    uint32 traceStart = TRACE_START();
+    CheckHKBuffer();
+    TRACE_END(TRACE_CHECK_HK, traceStart);
+    return 0;
+}
+
+static int LoopI2C()
+{
+    uint32 traceStart = TRACE_START();
+    CheckI2C();
+    TRACE_END(TRACE_CHECK_I2C, traceStart);
+    return 0;
+}
+
+static int LoopRTC()
+{
+    CheckRTC();
+    return 0;
+}
+
+/**
+ * @brief Main loop tasks, highest priority first. Each runs to completion when an event it waits on was posted
+ * or its deadline is up, the Event path leads so it gets the pass first under load.
+ */
+static const LoopTask tabLoopTask[] = {
+    {LoopEventPackets, LOOP_EV(LOOP_EV_EVENT), LOOP_EV(LOOP_EV_FRAME), BP_US_TO_TICKS(LOOP_POLL_US), FALSE},
+    {LoopFrameBuffer, LOOP_EV(LOOP_EV_FRAME), LOOP_EV(LOOP_EV_FRAME), BP_US_TO_TICKS(LOOP_FAST_US), FALSE}, //polls the DMA_HR_Data run
+    {CheckLRCmd, LOOP_EV(LOOP_EV_CMD), LOOP_EV(LOOP_EV_CMD), BP_US_TO_TICKS(LOOP_POLL_US), FALSE}, //ground commands ahead of the macros, they queue between packets
+    {CheckCmdMacros, LOOP_EV(LOOP_EV_CMD), LOOP_EV(LOOP_EV_CMD), BP_US_TO_TICKS(LOOP_POLL_US), FALSE},
+    {CheckCmdBuffers, LOOP_EV(LOOP_EV_CMD), LOOP_EV(LOOP_EV_CMD), BP_US_TO_TICKS(LOOP_FAST_US), FALSE}, //polls buffCmdTx for room
+    {LoopHKBuffer, 0, 0, BP_US_TO_TICKS(LOOP_POLL_US), FALSE},
+    {CheckLRScienceData, 0, 0, BP_US_TO_TICKS(LOOP_POLL_US), FALSE},
+    {LoopI2C, 0, 0, BP_US_TO_TICKS(LOOP_FAST_US), FALSE},
+    {InterpretCmdBuffers, LOOP_EV(LOOP_EV_CMD), LOOP_EV(LOOP_EV_CMD), BP_US_TO_TICKS(LOOP_POLL_US), TRUE},
+    {CheckUSB, 0, 0, BP_US_TO_TICKS(LOOP_POLL_US), TRUE},
+    {LoopRTC, 0, 0, BP_US_TO_TICKS(LOOP_POLL_US), TRUE},
+};
+#define LOOP_TASKS (sizeof(tabLoopTask) / sizeof(tabLoopTask[0]))
+typedef char loopAssertTasks[(16u >= LOOP_TASKS) ? 1 : -1]; //compile error if loopTasksPutOff has no bit for a task
+
+static uint32 loopTaskTick[LOOP_TASKS]; //bpTicks at the last run of each task
+static uint16 loopTasksPutOff = 0; //low priority tasks put off to the next pass, one bit each
+
+/**
+ * @brief Takes the events posted since the last pass
+ * @details Each is cleared before the tasks read what was queued, so one posted after the clear is for the next pass.
+ * @return uint8 LOOP_EV masks of the events posted
+ */
+static uint8 TakeLoopEvents()
+{
+    uint8 events = 0;
+    for (uint8 ev = 0; ev < LOOP_EVENTS; ev++)
+    {
+        if (FALSE != loopEvent[ev])
+        {
+            loopEvent[ev] = FALSE;
+            events |= LOOP_EV(ev);
+        }
+    }
+    return events;
+}
+
+#if LOOP_SLEEP
+/**
+ * @brief Sleeps with WFI until the next interrupt when no task is ready
+ * @details Checked with the interrupts masked, an ISR posting after the check leaves its interrupt pending
+ * and WFI returns at once. SysTick runs ISRTickBP every BP_TICK_US, so the deadlines are met to a tick.
+ * With LOOP_TICKLESS the SysTick period is stretched to the nearest task deadline first when no backplane
+ * board is due before it, so an idle CPU is not woken every tick.
+ */
+static void LoopSleep()
+{
+    if (0 != loopTasksPutOff) return;
+    uint8 intState = CyEnterCriticalSection();
+    uint8 ready = FALSE;
+    uint32 idleTicks = BP_TICK_STRETCH_MAX;
+    for (uint8 ev = 0; ev < LOOP_EVENTS; ev++)
+    {
+        ready |= loopEvent[ev];
+    }
+    for (uint8 i = 0; (FALSE == ready) && (i < LOOP_TASKS); i++)
+    {
+        uint32 elapsed = bpTicks - loopTaskTick[i];
+        ready = (elapsed >= tabLoopTask[i].periodTicks);
+        idleTicks = MIN(idleTicks, tabLoopTask[i].periodTicks - elapsed);
+    }
+    if (FALSE == ready)
+    {
+#if LOOP_TICKLESS
+        idleTicks = MIN(idleTicks, BackplaneIdleTicks());
+        uint8 stretched = (1u < idleTicks) ? StretchBackplaneTick(idleTicks) : FALSE;
+        __WFI();
+        if (TRUE == stretched)
+        {
+            EndBackplaneStretch();
+        }
+#else
+        __WFI();
+#endif
+    }
+    CyExitCriticalSection(intState);
+}
+#endif
+
+/**
+ * @brief One pass of the main loop, the tasks of tabLoopTask that are ready run once in priority order
+ * @details A task is ready when an ISR or a task before it posted one of its events, or its periodTicks deadline
+ * is up. One that did work posts its events again, so tasks above it run on the next pass. The pass and the main
+ * stages are timed into traceTiming. InterpretCmdBuffers, CheckUSB and CheckRTC are low priority, they are put off
+ * to the next pass when the pass is over loopBudgetUs, at most loopMaxDefer passes in a row. With LOOP_SLEEP the
+ * CPU then sleeps until an interrupt if no task is ready.
+ * @return int 0
+ */
+int MainLoopPass()
+{
+    uint32 loopStart = TRACE_NOW();
+    uint8 loopYield = FALSE;
+    uint8 events = TakeLoopEvents();
+    uint8 posted = 0;
+    uint32 tick = bpTicks;
+    for (uint8 i = 0; i < LOOP_TASKS; i++)
+    {
+        const LoopTask * task = &tabLoopTask[i];
+        uint16 bit = 1u << i;
+        if ((0 == (events & task->events)) && (0 == (loopTasksPutOff & bit)) && ((tick - loopTaskTick[i]) < task->periodTicks))
+        {
+            continue; //nothing posted and not due
+        }
+        if ((TRUE == task->lowPriority) && !LoopBudgetLeft(loopStart))
+        {
+            loopTasksPutOff |= bit;
+            loopYield = TRUE;
+            continue;
+        }
+        loopTasksPutOff &= ~bit;
+        loopTaskTick[i] = tick;
+        if (0 < task->run())
+        {
+            events |= task->posts; //for the tasks below in this pass
+            posted |= task->posts; //for the task and those above in the next
+        }
+    }
+    for (uint8 ev = 0; ev < LOOP_EVENTS; ev++)
+    {
+        if (0 != (posted & LOOP_EV(ev)))
+        {
+            loopEvent[ev] = TRUE;
+        }
+    }
+    loopCount++;
+    if (TRUE == loopYield)
+    {
+        loopDeferred++;
+        cntLoopYields++;
+    }
+    else
+    {
+        loopDeferred = 0;
+    }
+    TRACE_LOOP_END(loopStart);
+#if LOOP_SLEEP
+    LoopSleep();
+#endif
+    return 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,649 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Shared definitions for the hardware independent DAQ code of the Main PSOC.
+ * The daq_*.c modules only talk to hardware through the PSoC Creator generated
+ * component APIs (SPIS_Ev, SPIM_BP, UART_HR_Data, USBUART_CD, I2C_RTC, RTC_Main...)
+ * pulled in by project.h. The host build in ../host supplies its own project.h
+ * with simulated components so the same code can be replayed on a PC.
+ *
+ * ========================================
+*/
+
+#ifndef DAQ_H
+#define DAQ_H
+
+#include "project.h"
+#include "ring.h"
+#include "stdio.h"
+#include "string.h"
+//#include "math.h"
+#include "errno.h"
+
+#define MAJOR_VERSION 5 //MSB of version, changes on major revisions, able to readout in 1 byte expand to 2 bytes if need
+#define MINOR_VERSION 27 //LSB of version, changes every settled change, able to readout in 1 byte
+#define MIN(a,b) (((a)<(b))?(a):(b))
+#define MAX(a,b) (((a)>(b))?(a):(b))
+//#define WRAPINC(a,b) (((a)>=(b-1))?(0):(a + 1))
+#define WRAPINC(a,b) ((a + 1) % (b))
+#define WRAP3INC(a,b) ((a + 3) % (b))
+#define WRAPDEC(a,b) ((a + ((b) - 1)) % (b))
+#define WRAP(a,b) ((a) % (b)) //Macro to bring new calculated index a into the bounds of a circular buffer of size b
+#define ISELEMENTDONE(a,b,c) ((b <= c) ? ((a < b) || (a >= c)) : ((a < b) && (a >= c)) )//used to determine if element in circular buffer is done 
+#define ACTIVELEN(a,b,c) ((((c) - (a)) + (b)) % (c)) //Macro to calculate active length between a and b in circular buffer of size c. Exclusive, need to add 1 to make inclusive
+// From LROA103.ASM
+//;The format for the serial command is:
+//; S1234<sp>xyWS1234<sp>xyWS1234<sp>xyW<cr><lf>
+//; where 1234 is an ASCII encoded 16 bit command, with the format:
+//; Data Byte for boards:	1 = MSB high nibble, 2 = MSB low nibble
+//; Address Byte for boards: 3 = LSB high nibble, 4 = LSB low nibble
+//; S & W are literal format characters,<sp> = space, xy = CIP address (ignored).
+//; 9 characters are repeated 3 times followed by a carriage return - line feed,
+//; and all alpha characters must be capitalized, baud rate = 1200.
+#define START_COMMAND	(uint8*)("S") //Start command string before the 4 command char 
+#define START_COMMAND_SIZE	1u //Size of Start command string before the 4 command char 
+#define END_COMMAND	(uint8*)(" 01W") //End command string after the 4 command char, CIP is 01 which is ignored
+#define END_COMMAND_SIZE	 4u //Size of End command string after the 4 command char, CIP is 01 which is ignored
+//Binary command frames, selected by Main PSOC command 0x44 once the Event PSOC firmware takes them:
+//; A5 n d1 a1 ... dn an c
+//; n = 1 to CMD_FRAME_MAX commands of data byte, address byte as queued, c makes the byte sum of n through c 0.
+//; A5 is never a character of the legacy format, so the Event PSOC can tell the formats apart from the first byte.
+#define CMD_FRAME_SYNC	(0xA5u) //First byte of a binary command frame
+#define CMD_FRAME_MAX	(12u) //Commands in a binary frame, 3 + 2 * 12 bytes is no longer than the 29 byte legacy line
+#define CMD_FRAME_OVERHEAD	(3u) //Sync, count and checksum bytes of a binary frame
+#define CMD_LINE_REPEAT_SIZE	(START_COMMAND_SIZE + COMMAND_CHARS + END_COMMAND_SIZE) //One of the 3 copies in the legacy line
+#define CMD_LINE_SIZE	((3u * CMD_LINE_REPEAT_SIZE) + 2u) //Legacy line with the CR LF, 29 bytes
+//UART_Cmd TX buffer size is 29 in TopDesign, one legacy line. Lines and frames are queued in buffCmdTx instead, its TX interrupt feeds them to the FIFO
+#define CMD_TX_SIZE	(128u) //buffCmdTx, power of 2, 4 legacy lines or full binary frames queued for UART_Cmd
+#define LR_CMD_PORTS	(2u) //UART_LR_Cmd_1 and _2, command sources 0 and 1
+#define LR_CMD_RX_SIZE	(64u) //buffLRCmdRx of each port, power of 2, 66 ms of bytes at 9600 baud before ISRCheckCmd drops them
+#define CR	(0x0Du) //Carriage return in hex
+#define LF	(0x0Au) //Line feed in hex
+#define DLE	(0x10u) //Data Link Escape Used as low rate packet header
+#define ETX	(0x03u) //Data Link Escape Used as low rate packet trailer
+//Low rate command packet: DLE CMD_ID len d1 a1 ... ETX. len 2 is one command with no checksum as before,
+//len 4 to 254 even is a batch of len / 2 commands followed by a checksum byte making the byte sum of len through it 0.
+#define CMD_ID	(0x14u) //ID byte for command in low rate packet
+#define CMD_BATCH_MIN_LEN	(4u) //len of the smallest batched command packet, 2 commands
+#define REQ_ID	(0x13u) //ID byte for request science data in low rate packet
+#define SDATA_ID	(0x53u) //ID byte for science data in low rate packet
+#define FILLBYTE (0xA3u) //SPI never transmits  so could be anything
+//#define CMDBUFFSIZE 3
+/* Project Defines */
+#define FALSE  0
+#define TRUE   1
+#define SPI_BUFFER_SIZE  (512u) //buffSPI of a board with science data
+//#define SPI_BUFFER_SIZE  (1024u)
+#define SPI_BUFFER_SIZE_HV  (256u) //buffSPI of a HV board
+#define SPI_POOL_SIZE  ((5u * SPI_BUFFER_SIZE) + (2u * SPI_BUFFER_SIZE_HV)) //sum of the buffSPI sizes in tabSPIDev
+#define EV_BUFFER_SIZE  (1024u)
+typedef uint16 SPIBufferIndex; //type of variable indexing the SPI buffer. should be uint8 or uint16 based on size
+typedef uint16 EvBufferIndex; //type of variable indexing the Event buffer. should be uint16
+
+#define USBFS_DEVICE	(0u)
+/* The buffer size is equal to the maximum packet size of the IN and OUT bulk
+* endpoints.
+*/
+#define USBUART_BUFFER_SIZE	(64u)
+#define LINE_STR_LENGTH	(20u)
+
+//#define NUM_SPI_DEV	(5u)
+#define NUM_SPI_DEV	(7u) //every backplane select line, see tabSPIDev
+
+#define NULL_HEAD	(0xF9u)
+#define POW_HEAD	(0xF6u)
+#define PHA_HEAD	(0xF3u)
+#define CTR1_HEAD	(0xF8u)
+#define TKR_HEAD	(0xF4u)
+#define CTR3_HEAD	(0xFAu)
+#define HV1_HEAD	(0xFBu) //provisional, HV boards are not polled by default
+#define HV2_HEAD	(0xFCu)
+#define EOR_HEAD	(0xFFu)
+#define DUMP_HEAD	(0xF5u)
+#define ENDDUMP_HEAD	(0xF7u)
+#define EVFIX_HEAD	(0xDBu) //Event PSOC fixed length packet
+#define EVVAR_HEAD	(0xDCu) //Event PSOC variable length packet
+#define EVHK_ID	(0xDEu) //Event PSOC HK ID
+
+enum readStatus {CHECKDATA, READOUTDATA, EORFOUND, EORERROR};
+enum eventFrameStatus {EV_FIND_HEAD, EV_CHECK_00, EV_CHECK_FF, EV_CHECK_LEN, EV_CHECK_EOR};
+enum commandStatus {WAIT_DLE, CHECK_ID, CHECK_LEN, READ_CMD, CHECK_SUM, CHECK_ETX_CMD, CHECK_ETX_REQ};
+enum eventLowRateCopyState {NO_EVENT_LR_COPY, COPY_EVENT_HK, COPY_LAST_EVENT};//
+enum cmdLinkFormat {CMD_LINK_ASCII, CMD_LINK_BINARY}; //UART_Cmd format, legacy triplicated ASCII lines or binary frames
+enum frameSource {FRAME_SRC_EVENT, FRAME_SRC_BP, FRAME_SRC_HK, FRAME_SOURCES}; //packet sources CheckFrameBuffer schedules
+enum traceStage {TRACE_ISR_READ_EV, TRACE_ISR_READ_SPI, TRACE_CHECK_EVENT, TRACE_CHECK_FRAME, TRACE_CHECK_HK, TRACE_CHECK_I2C, TRACE_MAIN_LOOP, TRACE_STAGES}; //timed code, order of the stages in DiagnosticPeriodic
+enum tracePeak {TRACE_PEAK_EV, TRACE_PEAK_PACKET_EV, TRACE_PEAK_SPI, TRACE_PEAK_CMD, TRACE_PEAK_I2C, TRACE_PEAKS}; //buffers with a peak occupancy, order in DiagnosticPeriodic
+#define COMMAND_SOURCES 3
+#define COMMAND_CHARS	(4u)
+
+typedef struct PacketEvent {
+	EvBufferIndex header;
+	EvBufferIndex EOR; //last byte (inclusive) in the read should be LSB FF of FF00FF  
+} PacketEvent;
+
+#define PACKET_EVENT_SIZE	 (16u)
+#define EV_DUMP_SIZE (EV_BUFFER_SIZE - WRAP(EV_BUFFER_SIZE, FRAME_DATA_BYTES))
+#define EV_MIN_SIZE (9u)
+#define EV_MAX_SIZE (255u + 9u) //max 1 byte len + addtional bytes
+
+typedef struct PacketLocation {
+	SPIBufferIndex index;
+	SPIBufferIndex header;
+	SPIBufferIndex EOR; //last byte (inclusive) in the read should be LSB FF of FF00FF  
+} PacketLocation;
+
+#define PACKET_FIFO_SIZE	 (128u) //backplane packets of all the boards waiting for the frames
+
+#define FRAME_DATA_BYTES	(27u)
+#define FRAME_BUFFER_BLOCKS	(6u) //Number of blocks in the buffer, should me changed based on availiaable SRAM. 256 frames takes about 14%
+#define FRAME_BUFFER_BLOCK_SIZE	(256u) //choosen so LSB of seq can be preset in buffer
+#define FRAME_BUFFER_SIZE	(FRAME_BUFFER_BLOCKS * FRAME_BUFFER_BLOCK_SIZE) //Calculate size, do not change 
+typedef struct FrameOutput {
+	uint8 seqH;
+	uint8 seqM;
+	uint8 seqL;
+	uint8 sync[4];
+	uint8 data[FRAME_DATA_BYTES];
+} FrameOutput;
+typedef uint16 FmBufferIndex; //type of variable indexing the Frame buffer. should be uint16
+#ifndef FRAME_USB_GATHER
+#define FRAME_USB_GATHER (1u) //1 USB builds the frames of an Event packet from buffEv, buffFrameData is read by USB only for the other packets. 0 USB sends the frames in buffFrameData
+#endif
+#define FRAME_USB_DESCS (64u) //packets framed and not sent to USB yet, power of 2
+#define FRAME_USB_EV_HOLD (EV_BUFFER_SIZE / 2u) //most buffEv bytes USB keeps from ISRReadEv, its oldest packets are dropped past that
+#define FRAME_USB_HOLD_FRAMES (FRAME_BUFFER_SIZE - ((SPI_BUFFER_SIZE / FRAME_DATA_BYTES) + 1u)) //most frames queued to USB, so the next packet (at most a buffSPI) never overwrites a frame USB copies
+typedef struct FrameUsbDesc {
+    uint8 src; //frameSource of the packet
+    uint8 gather; //TRUE the frames are built from header, nBytes of buffEv, FALSE copied from buffFrameData
+    FmBufferIndex frame; //first frame of the packet in buffFrameData, its index is the seqL
+    FmBufferIndex nFrames; //frames the packet took
+    uint16 seq2HB; //seqH and seqM of the first frame
+    EvBufferIndex header; //first byte of an Event packet in buffEv
+    EvBufferIndex nBytes; //bytes of an Event packet, header to EOR inclusive
+} FrameUsbDesc;
+
+#define HK_BUFFER_PACKETS	(2u) //Number of houskeeping packets to buffer, min 2 
+#define HK_PAD_SIZE	21 //number of padding bytes need for 
+//typedef struct HousekeepingPeriodic { //intended to Mimic Counter 1 (Power-Counter  Formats V3.txt) for early baro testing 
+//	uint8 header[3];
+//	uint8 version[2];
+//	uint8 secs[4];
+//	uint8 paddingTemp[21];
+//	uint8 baroTemp1[3];
+//	uint8 baroPres1[3];
+//    uint8 baroTemp2[3];
+//	uint8 baroPres2[3];
+//	uint8 padding[HK_PAD_SIZE];
+//	uint8 EOR[3];
+//} HousekeepingPeriodic;
+//typedef struct HousekeepingPeriodic {// swaped pres and temperature for debug
+//	uint8 header[3];
+//	uint8 version[2];
+//	uint8 secs[4];
+//	uint8 paddingTemp[21];
+//	uint8 baroPres1[3];
+//	uint8 baroTemp1[3];
+//	uint8 baroPres2[3];
+//    uint8 baroTemp2[3];
+//	uint8 padding[HK_PAD_SIZE];
+//	uint8 EOR[3];
+//} HousekeepingPeriodic;
+typedef struct HousekeepingPeriodic {
+	uint8 header[3];
+    uint8 packedTimeDate[4];//
+    uint8 commandLast[2];//
+    uint8 commandCount[2];//
+    uint8 commandErrors;//
+    uint8 generalErrors;//
+    uint8 missingValuesThisPacket;//
+    uint8 fifoPercentFull;//0-100
+    uint8 framesDroppedRS232[2];//
+    uint8 framesDroppedUSB[2];//
+	uint8 baroPres1[4];
+	uint8 baroTemp1[4];
+	uint8 baroPres2[4];
+    uint8 baroTemp2[4];
+    uint8 baroPres3[3];//I2C Address 1110000
+    uint8 baroTemp3[3];//I2C Address 1110000
+    uint8 boardTemperature[2];//I2C Address 1001000
+    uint8 coreDieTemp[2];//
+    uint8 digital3VVoltage[2];//I2C Address 1000100
+    uint8 digital3VAmperage[2];//I2C Address 1000100
+    uint8 analog3VVoltage[2];//I2C Address 1000011
+    uint8 analog3VAmperage[2];//I2C Address 1000011
+    uint8 digital5VVoltage[2];//I2C Address 1000001
+    uint8 digital5VAmperage[2];//I2C Address 1000001
+    uint8 analog5VVoltage[2];//I2C Address 1000101
+    uint8 analog5VAmperage[2];//I2C Address 1000101
+    uint8 digital15VVoltage[2];//I2C Address 1000010
+    uint8 trackerVoltage[2];//I2C Address 1000000
+    uint8 trackerAmperage[2];//I2C Address 1000000
+    uint8 trackerBiasVoltage[2];//I2C Address 1000110
+	uint8 EOR[3];
+} HousekeepingPeriodic;
+
+#define HK_HEAD	(0xD0u) //ID for Main PSOC Housekeeping
+//#define HK_HEAD	(0xF8u) //usign counter1 for main PSOC hk right now DEBUG
+
+#ifndef DAQ_TRACE
+#define DAQ_TRACE (1u) //1 times the stages in traceStage and sends a DiagnosticPeriodic after each HK packet. 0 compiles the tracing out
+#endif
+#ifndef TRACE_NOW
+#define TRACE_NOW() (DWT->CYCCNT) //free running CPU cycle counter, started by InitTrace
+#endif
+#if DAQ_TRACE
+#define TRACE_START() TRACE_NOW()
+#define TRACE_END(stage, start) TraceEnd((stage), (start))
+#define TRACE_PEAK(peak, n) do { uint16 tracePeakN = (n); if (tracePeakN > tracePeak[(peak)]) tracePeak[(peak)] = tracePeakN; } while (0)
+#define TRACE_LOOP_END(start) TraceLoopEnd(start)
+#else
+#define TRACE_START() (0u)
+#define TRACE_END(stage, start) do { } while (0)
+#define TRACE_PEAK(peak, n) do { } while (0)
+#define TRACE_LOOP_END(start) do { } while (0)
+#endif
+#define LOOP_HIST_BUCKETS (16u) //log2 buckets of the main loop pass time, bucket 0 is under 256 cycles, bucket n is 2^(n+7) up to 2^(n+8), the last has the rest
+#define LOOP_BUDGET_US (1000u) //default time a pass can take before InterpretCmdBuffers, CheckUSB and CheckRTC are put off to the next pass, 0 never puts them off
+#define LOOP_MAX_DEFER (4u) //default passes in a row the low priority tasks can be put off
+#ifndef LOOP_WDT
+#define LOOP_WDT (1u) //1 starts the watchdog before the main loop, reset if a pass takes longer than 2 to 3 s (1024 ILO ticks). Cannot be stopped once started
+#endif
+#ifndef LOOP_SLEEP
+#define LOOP_SLEEP (1u) //1 sleeps the CPU with WFI after a pass when no main loop task is ready, SysTick (ISRTickBP) wakes it every BP_TICK_US at the latest. 0 runs the passes back to back
+#endif
+#ifndef LOOP_TICKLESS
+#define LOOP_TICKLESS (1u) //1 stretches the SysTick period before a LOOP_SLEEP WFI up to the next task deadline when no backplane board is due or polled. 0 SysTick wakes it every BP_TICK_US
+#endif
+#define LOOP_POLL_US (1000u) //deadline of the main loop tasks with no event posted, they run at least this often
+#define LOOP_FAST_US (100u) //deadline of CheckFrameBuffer, CheckCmdBuffers and CheckI2C, which wait on hardware with no interrupt
+#define LOOP_EV(ev) (1u << (ev)) //mask of a loopEvent
+
+typedef struct TraceTiming {
+    uint32 calls; //calls since the last diagnostic packet
+    uint32 last; //cycles of the last call
+    uint32 peak; //most cycles of a call since the last diagnostic packet
+} TraceTiming;
+
+typedef struct DiagnosticPeriodic {
+	uint8 header[3];
+    uint8 clockMHz; //trace clock, cycles per us
+    uint8 sequence; //counts diagnostic packets, a gap means an interval was merged into the next
+    uint8 stage[TRACE_STAGES][9]; //per traceStage: calls, last cycles, peak cycles, 3 bytes each MSB first, saturated
+    uint8 occupancyPeak[TRACE_PEAKS][2]; //per tracePeak: most elements in use, MSB first
+    uint8 loopHist[LOOP_HIST_BUCKETS][3]; //main loop passes per log2 bucket of cycles, MSB first, saturated
+    uint8 loopYields[3]; //passes that put off the low priority tasks, MSB first, saturated
+	uint8 EOR[3];
+} DiagnosticPeriodic;
+
+#define DIAG_HEAD	(0xD1u) //ID for Main PSOC diagnostic timing packet
+
+typedef struct LowRateHousekeeping {
+	uint8 dle; //0x10
+    uint8 scienceDataID;// 0x53
+    uint8 dataLength;//calculated from the sizeof
+    uint8 mainMajorV;//Major version of Main PSOC
+    uint8 mainMinorV;//Minor version of Main PSOC
+    uint8 mainHK[66];//Main housekeeping except header and footer
+    uint8 eventHK[75];//Event housekeeping Packed date thru percent live time
+    uint8 etx;//0x03
+} LowRateHousekeeping;
+
+#define DMA_HR_Data_BYTES_PER_BURST 1
+#define DMA_HR_Data_REQUEST_PER_BURST 1
+#define DMA_HR_Data_SRC_BASE (CYDEV_SRAM_BASE)
+#define DMA_HR_Data_DST_BASE (CYDEV_PERIPH_BASE)
+#define DMA_HR_Data_BUFFER_SIZE 16
+#define DMA_HR_Data_TD_FRAMES (8u) //frames one TD moves, at most 120 for the 12 bit TD count. The writer waits on the frames of a run not sent yet, so keep runs short, 32 frames are 94 ms at 115.2k
+#define DMA_HR_Data_TDS (4u) //TDs chained for one run of frames
+#define DMA_HR_Data_RUN_FRAMES (DMA_HR_Data_TDS * DMA_HR_Data_TD_FRAMES) //most frames sent in one DMA_HR_Data transaction
+#define DMA_HR_Data_HEADROOM (FRAME_BUFFER_SIZE / 2) //frames left for the writer ahead of a run as it starts, HR drops its oldest frames past that so USB is not held up by the run
+
+#define NUMBER_INIT_CMDS	(40 + 90 + 5 + 11 + 1)//segments are divived by comments for easier counting
+#define CMD_BUFFER_SIZE 256 // power of 2, a batched packet of 127 commands fits with 128 still queued. The init commands are sent from initCmd, not queued here
+#define CMD_MAIN_PSOC_ADDRESS 0b00101000 // Middle nibble of the second command byte is the address (0b1010 for Main PSOC, Event is 0b1000)
+#define CMD_MAIN_FIRST_BYTE 0b00101001 // Middle nibble of the second command byte is the address (0b1010 for Main PSOC, Event is 0b1000)
+#define CMD_ADDRESS_MASK 0b00111100 // Middle nibble of the second command byte mask for address
+#define CMD_NUM_BYTE_MASK 0b11000011 // Outer nibble of the second command byte mask for number of bytes
+#define CMD_MAIN_BYTE_ADDRESS(n) (CMD_MAIN_PSOC_ADDRESS | (((n) & 0xC) << 4) | ((n) & 3)) // Address byte of data-byte command n, also the header of a command with n data bytes
+#define CMD_MAIN_MAX_DATA (15u) // Most data-byte commands after a Main PSOC command header
+#define CMD_INTERPRET_US (200u) // time InterpretCmdBuffers keeps executing Main PSOC commands in a pass, at least one is executed
+#define MAIN_CMD_DATA_UP_TO (0x80u) // tabMainCmd dataBytes flag, 1 up to the data bytes in the low bits can follow
+
+#define CMD_MACROS (8u) // command macro slots, run by CMD_MACRO_RUN_ID + slot
+#define CMD_MACRO_SIZE (256u) // bytes of a macro slot, 16 EEPROM rows, CMD_MACROS of them fill the 2 KB EEPROM
+#define CMD_MACRO_CMDS ((CMD_MACRO_SIZE - 2u) / 2u) // commands a macro holds after its header
+#define CMD_MACRO_ROWS (CMD_MACRO_SIZE / CYDEV_EEPROM_ROW_SIZE) // EEPROM rows of a macro slot, a CyWriteRowData each
+#define CMD_MACRO_CHUNK (16u) // most macro commands queued to buffCmd in a pass
+#define CMD_MACRO_RUN_ID 0x60 // Main PSOC command ID running macro slot 0, up to slot CMD_MACROS - 1
+#define CMD_EVENT_LINK_ASCII 0x6E // provisional Event PSOC command ID, no data bytes, legacy ASCII lines follow
+#define CMD_EVENT_LINK_BINARY 0x6F // provisional Event PSOC command ID, no data bytes, binary frames follow
+#define CMD_EVENT_ADDRESS 0b00100000 // Event PSOC address byte with no data bytes to follow
+
+#define I2C_ADDRESS_TMP100 0x48
+#define I2C_ADDRESS_BAROMETER 0x70
+#define I2C_ADDRESS_RTC 0x6F
+#define I2C_ADDRESS_INA226_3V_DIG 0x44
+#define I2C_ADDRESS_INA226_3V_ANA 0x43
+#define I2C_ADDRESS_INA226_5V_DIG 0x41
+#define I2C_ADDRESS_INA226_5V_ANA 0x45
+#define I2C_ADDRESS_INA226_15V_DIG 0x42
+#define I2C_ADDRESS_INA226_TRACKER_SUPPLY 0x40//I2C Address 1000000 on Tracker power board
+#define I2C_ADDRESS_INA226_TRACKER_BIAS 0x46//I2C Address 1000110 on Tracker power board
+
+typedef struct I2CTrans {
+	uint8 type;
+    uint8 slaveAddress;
+    uint8 * data;
+    uint8 cnt;
+    uint8 mode;
+	uint8 error;
+} I2CTrans;
+
+#define I2C_BUFFER_SIZE (64u)
+#define I2C_READ (1u)
+#define I2C_WRITE (0u)
+
+typedef struct HousekeepingTrackI2C {
+    uint8 slaveAddress;
+    uint8 regAddress;
+    uint8 cnt;
+    uint8 * data;
+    uint8 writeTrans;
+    uint8 readTrans;
+} HousekeepingTrackI2C;
+
+#define NO_WRITE_REG_ADDRESS (255u)
+#define MAIN_HK_I2C_BUFFER_SIZE (14u)
+
+#define RTS_SET_MAIN        (0x01)
+#define RTS_SET_I2C         (0x02)
+#define RTS_SET_EVENT       (0x04)
+#define RTS_SET_RPI         (0x08)
+#define RTS_SET_MAIN_INP    (0x10)
+#define RTS_SET_I2C_INP     (0x20)
+
+#define DATA_RTS_I2C_BYTES   (8u)
+
+typedef struct BaroCoeff {
+	const double U0;
+	const double Y1;
+	const double Y2;
+	const double Y3;
+	const double C1;
+	const double C2;
+	const double C3;
+	const double D1;
+	const double D2;
+	const double T1;
+	const double T2;
+	const double T3;
+	const double T4;
+	const double T5;
+} BaroCoEff;
+
+#define BARO_COUNT_TO_US (12)
+#define NUM_BARO 2
+#define NUM_BARO_CAPTURES 128//8
+#define BARO_COUNT_MAX 0xFFFE //65534 is the max count on a 16 counter
+
+#define BP_TICK_US (50u) //SysTick period pacing ISRTickBP
+#define BP_TICK_CYCLES (BP_TICK_US * (BCLK__BUS_CLK__HZ / 1000000u)) //bus clocks of a SysTick period
+#define BP_TICK_STRETCH_MAX (0x01000000u / BP_TICK_CYCLES) //most ticks a stretched SysTick period holds, the counter has 24 bits
+#define BP_SELECT_LOW_US (1000u) //default time a board is held with select low before it is polled
+#define BP_POLL_US (4000u) //default time a board is polled with select high for nDrdy before the next board
+#define BP_US_TO_TICKS(us) (((uint32)(us) + BP_TICK_US - 1u) / BP_TICK_US)
+
+typedef struct BPSchedule {
+    uint16 lowUs; //select low before polling, rounded up to BP_TICK_US
+    uint16 pollUs; //select high waiting for nDrdy low, then the next board. 0 the board is not polled
+} BPSchedule;
+
+typedef struct BPDevice {
+    void (*select)(uint8); //writes the select line of the board
+    uint8 head; //header byte put in front of the board packets
+    SPIBufferIndex size; //bytes of the board buffSPI, power of 2
+} BPDevice;
+
+enum mainCmdSlot {MAIN_CMD_NONE, MAIN_CMD_HK_PERIOD, MAIN_CMD_RTC_FLAGS, MAIN_CMD_CLEAR_COUNTERS, MAIN_CMD_BUSY_THRES, MAIN_CMD_FRAME_SCHED,
+                  MAIN_CMD_LOOP_BUDGET, MAIN_CMD_LINK_FORMAT, MAIN_CMD_SET_RTC, MAIN_CMD_INIT_RTC, MAIN_CMD_RESET_EV_HW, MAIN_CMD_RESET_EV_SW,
+                  MAIN_CMD_INIT_CMDS, MAIN_CMD_BP_POLL, MAIN_CMD_I2C_RETRIES, MAIN_CMD_MACRO_BEGIN, MAIN_CMD_MACRO_APPEND, MAIN_CMD_MACRO_SAVE,
+                  MAIN_CMD_MACRO_RUN, MAIN_CMDS}; //entries of tabMainCmd, tabMainCmdSlot maps the command IDs to them
+
+typedef struct MainCmd {
+    int (*run)(uint8 cmdID, const uint8 * data, uint8 numDataBytes); //executes the command, 0 or negative errno
+    uint8 dataBytes; //data-byte commands that must follow the header, with MAIN_CMD_DATA_UP_TO the most of them
+} MainCmd;
+
+enum loopEvent {LOOP_EV_EVENT, LOOP_EV_FRAME, LOOP_EV_CMD, LOOP_EVENTS}; //work posted to the main loop tasks: buffEv bytes, packets to frame, commands to forward or interpret
+
+typedef struct LoopTask {
+    int (*run)(); //runs the task once, above 0 when it did work and may have more
+    uint8 events; //LOOP_EV masks that make it ready
+    uint8 posts; //LOOP_EV masks posted when run returns above 0
+    uint16 periodTicks; //deadline in bpTicks, ready this long after its last run with nothing posted
+    uint8 lowPriority; //TRUE to put it off to the next pass when the pass is over loopBudgetUs
+} LoopTask;
+
+typedef struct CmdMacro {
+    uint8 numCmds; //commands in the macro, 0 or erased EEPROM (0xFF) is empty
+    uint8 sum; //makes the sum of the header and command bytes 0, a slot cut short by a reset while saved fails it
+    uint8 cmd[CMD_MACRO_CMDS][2]; //data byte then address byte, as queued to buffCmd
+} CmdMacro;
+
+RING_ASSERT_POW2(EV_BUFFER_SIZE, buffEv);
+RING_ASSERT_POW2(SPI_BUFFER_SIZE, buffSPI);
+RING_ASSERT_POW2(SPI_BUFFER_SIZE_HV, buffSPIHV);
+RING_ASSERT_POW2(CMD_BUFFER_SIZE, buffCmd);
+RING_ASSERT_POW2(CMD_TX_SIZE, buffCmdTx);
+RING_ASSERT_POW2(LR_CMD_RX_SIZE, buffLRCmdRx);
+RING_ASSERT_POW2(I2C_BUFFER_SIZE, buffI2C);
+typedef char cmdMacroAssertSize[(CMD_MACRO_SIZE == sizeof(CmdMacro)) ? 1 : -1]; //compile error if a macro slot is not CMD_MACRO_SIZE
+RING_ASSERT_POW2(PACKET_EVENT_SIZE, packetEv);
+RING_ASSERT_POW2(PACKET_FIFO_SIZE, packetFIFO);
+RING_ASSERT_POW2(FRAME_USB_DESCS, buffFrameUsb);
+RING_ASSERT_POW2(NUM_BARO_CAPTURES, buffBaroCap);
+
+/* daq.c */
+extern uint8 cntError;//count of general errors
+extern uint8 loopCount;
+extern uint8 buffUsbTx[USBUART_BUFFER_SIZE];
+extern uint8 iBuffUsbTx;
+extern uint8 buffUsbTxDebug[USBUART_BUFFER_SIZE];
+extern uint8 iBuffUsbTxDebug;
+extern uint16 loopBudgetUs;
+extern uint32 loopBudgetCycles;
+extern uint8 loopMaxDefer;
+extern uint8 loopDeferred;
+extern uint32 cntLoopYields;
+extern volatile uint8 loopEvent[LOOP_EVENTS];
+void InitBuffers();
+void SetLoopBudget(uint16 budgetUs, uint8 maxDefer);
+int MainLoopPass();
+
+/* daq_cmd.c */
+extern enum commandStatus commandStatusC[COMMAND_SOURCES];
+extern uint8 commandLenC[COMMAND_SOURCES];
+extern uint8 commandPosC[COMMAND_SOURCES];
+extern uint8 commandSumC[COMMAND_SOURCES];
+extern uint8 commandWriteC[COMMAND_SOURCES];
+extern uint8 curCmd[COMMAND_CHARS+1];
+extern const uint8 initCmd[NUMBER_INIT_CMDS][2];
+extern uint8 buffCmd[COMMAND_SOURCES][CMD_BUFFER_SIZE][2];
+extern uint8 readBuffCmd[COMMAND_SOURCES];
+extern volatile uint8 writeBuffCmd[COMMAND_SOURCES];
+extern uint8 orderBuffCmd[COMMAND_SOURCES];
+extern uint8 headerBuffCmd[COMMAND_SOURCES];
+extern uint8 interpretBuffCmd[COMMAND_SOURCES];
+extern uint8 lastCmdSource;
+extern uint8 initCmdPos;
+extern volatile uint16 cntCmd;
+extern uint8 cntCmdError;
+extern uint8 cmdLine[CMD_LINE_SIZE];
+extern uint8 buffCmdTx[CMD_TX_SIZE];
+extern volatile uint8 buffCmdTxRead;
+extern volatile uint8 buffCmdTxWrite;
+extern enum cmdLinkFormat cmdLinkFormat;
+extern enum cmdLinkFormat cmdLinkRequest;
+extern uint8 buffLRCmdRx[LR_CMD_PORTS][LR_CMD_RX_SIZE];
+extern volatile uint8 buffLRCmdRxRead[LR_CMD_PORTS];
+extern volatile uint8 buffLRCmdRxWrite[LR_CMD_PORTS];
+extern volatile uint16 cntLRCmdRxLost[LR_CMD_PORTS];
+int CmdBytes2String (uint8* in, uint8* out);
+void EncodeCmdLine(const uint8 * in);
+int SendCmdLine(const uint8 * in);
+int SendCmdString (uint8 * in);
+int SetCmdLinkFormat(uint8 format);
+int SendInitCmds();
+int ParseCmdInputByte(uint8 tempRx, uint8 i);
+int CheckCmdBuffers();
+int InterpretCmdBuffers();
+int CheckUSB();
+int CheckLRCmd();
+CY_ISR_PROTO(ISRCheckCmd);
+
+/* daq_macro.c */
+extern CmdMacro cmdMacro[CMD_MACROS];
+extern CmdMacro cmdMacroEdit;
+extern uint8 cmdMacroEditSlot;
+extern uint8 cmdMacroRunSlot;
+extern uint8 cmdMacroRunPos;
+extern uint8 cmdMacroSaveSlot;
+extern uint8 cmdMacroSavePending;
+void InitCmdMacros();
+int BeginCmdMacro(uint8 slot);
+int AppendCmdMacro(const uint8 * cmds, uint8 numBytes);
+int SaveCmdMacro();
+int RunCmdMacro(uint8 slot);
+int CheckCmdMacros();
+
+/* daq_event.c */
+extern uint8 buffEv[EV_BUFFER_SIZE];
+extern volatile EvBufferIndex buffEvRead;
+extern volatile EvBufferIndex buffEvWrite;
+extern volatile uint16 cntEvDropped;
+extern PacketEvent packetEv[PACKET_EVENT_SIZE];
+extern uint8 packetEvHead;
+extern uint8 packetEvTail;
+extern enum eventFrameStatus evFrameStatus;
+extern EvBufferIndex evFrameStart;
+extern EvBufferIndex evFrameCur;
+void InitEventFramer();
+int8 CheckEventPackets();
+CY_ISR_PROTO(ISRReadEv);
+
+/* daq_frame.c */
+extern const uint8 frame00FF[2];
+extern const uint8 frameSync[2];
+extern enum eventLowRateCopyState eventLRCopy;
+extern FrameOutput buffFrameData[FRAME_BUFFER_SIZE];
+extern FmBufferIndex buffFrameDataRead;
+extern FmBufferIndex buffFrameDataReadUSB;
+extern FmBufferIndex buffFrameDataWrite;
+extern uint8 frameFill;
+extern uint8 frameSchedQuantum[FRAME_SOURCES];
+extern uint8 frameSchedMaxWait;
+extern uint16 frameSchedWaitPeak[FRAME_SOURCES];
+extern uint8 usbFrameOffset;
+extern FrameOutput usbFrameCarry;
+extern FrameUsbDesc buffFrameUsb[FRAME_USB_DESCS];
+extern uint8 buffFrameUsbRead;
+extern uint8 buffFrameUsbWrite;
+extern uint8 usbNeedZLP;
+extern uint16 seqFrame2HB;
+extern uint16 cntFramesDropped;
+extern uint16 cntFramesDroppedUSB;
+extern uint8 DMAHRDataChan;
+extern uint8 DMAHRDataTd[DMA_HR_Data_TDS];
+extern FmBufferIndex DMAHRDataRun;
+extern uint8 DMAHRDataActive;
+FmBufferIndex InitFrameBuffer();
+void InitFrameDMA();
+void FrameAppend(const uint8 * src, uint16 n);
+void FrameFlush();
+int8 CheckFrameBuffer();
+
+/* daq_bp.c */
+extern uint8 iSPIDev;
+extern const BPDevice tabSPIDev[NUM_SPI_DEV];
+extern uint8 * buffSPI[NUM_SPI_DEV];
+extern SPIBufferIndex buffSPIRead[NUM_SPI_DEV];
+extern volatile SPIBufferIndex buffSPIWrite[NUM_SPI_DEV];
+extern SPIBufferIndex buffSPICurHead[NUM_SPI_DEV];
+extern SPIBufferIndex buffSPICompleteHead[NUM_SPI_DEV];
+extern PacketLocation packetFIFO[PACKET_FIFO_SIZE];
+extern uint8 packetFIFOHead;
+extern volatile uint8 packetFIFOTail;
+extern volatile uint8 continueRead;
+extern enum readStatus readStatusBP;
+extern BPSchedule bpSchedule[NUM_SPI_DEV];
+extern volatile uint32 bpTicks;
+extern uint32 bpLowTick[NUM_SPI_DEV];
+void InitBackplaneBuffers();
+void InitBackplane();
+int SetBackplanePoll(uint8 dev, uint16 pollUs);
+uint32 BackplaneIdleTicks();
+uint8 StretchBackplaneTick(uint32 ticks);
+void EndBackplaneStretch();
+CY_ISR_PROTO(ISRTickBP);
+CY_ISR_PROTO(ISRReadSPI);
+CY_ISR_PROTO(ISRWriteSPI);
+
+/* daq_hk.c */
+extern HousekeepingPeriodic buffHK[HK_BUFFER_PACKETS];
+extern uint8 buffHKRead;
+extern uint8 buffHKWrite;
+extern LowRateHousekeeping lowRateHK;
+extern I2CTrans buffI2C[I2C_BUFFER_SIZE];
+extern uint8 buffI2CRead, buffI2CWrite;
+extern uint8 numI2CRetry;
+extern uint8 I2CMaxRetries;
+extern RTC_Main_TIME_DATE mainTimeDate;
+extern uint8 rtcStatus;
+extern uint16 buffBaroCap[NUM_BARO *2][NUM_BARO_CAPTURES];
+extern uint8 buffBaroCapRead[NUM_BARO *2];
+extern volatile uint8 buffBaroCapWrite[NUM_BARO *2];
+extern uint32 curBaroTempCnt[NUM_BARO];
+extern uint32 curBaroPresCnt[NUM_BARO];
+extern volatile uint8 cntSecs;
+extern uint8 hkSecs;
+extern volatile uint8 hkReq;
+extern uint8 hkCollecting;
+extern volatile uint8 lowRateReq;
+extern uint8 outputBusy;
+extern uint8 outputBusyHighThres;
+extern uint8 outputBusyLowThres;
+uint8 BCD2Dec( uint8 bcd );
+uint8 Dec2BCD( uint8 dec );
+int InitLRScienceData();
+int CheckLRScienceData();
+uint8 CheckI2C();
+int8 ForcedSampleBaroI2C();
+int8 InitBaroI2COTP();
+uint8 InitRTC();
+uint8 InitHKBuffer();
+uint8 CheckHKBuffer();
+uint8 CheckRTC();
+CY_ISR_PROTO(ISRBaroCap);
+
+/* daq_trace.c */
+extern TraceTiming traceTiming[TRACE_STAGES];
+extern uint16 tracePeak[TRACE_PEAKS];
+extern uint32 loopHist[LOOP_HIST_BUCKETS];
+extern DiagnosticPeriodic buffDiag;
+extern uint8 diagReady;
+void InitTrace();
+void TraceEnd(uint8 stage, uint32 start);
+void TraceLoopEnd(uint32 start);
+void TraceOccupancy();
+void FillDiagPacket();
+
+#endif /* DAQ_H */
+/* [] END OF FILE */
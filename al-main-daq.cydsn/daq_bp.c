@@ -0,0 +1,599 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Backplane SPI master: polling of the backplane boards through the select
+ * lines, readout by ISRReadSPI/ISRWriteSPI and queueing into packetFIFO.
+ * Every board in tabSPIDev sits with select low while another one is read, so
+ * the low periods overlap and a board is polled once its own lowUs is up.
+ *
+ * ========================================
+*/
+
+#include "daq.h"
+
+uint8 iSPIDev = 0u;
+//uint8 frameSPIDev = 0u;
+//#define POW_SEL		(0x01u)
+//#define PHA_SEL		(0x02u)
+//#define CTR1_SEL	(0x03u)
+//#define TKR_SEL		(0x0Bu)
+//#define CTR3_SEL	(0x0Cu)
+//const uint8 tabSPISel[NUM_SPI_DEV] = {POW_SEL, PHA_SEL, CTR1_SEL, TKR_SEL, CTR3_SEL};
+//const uint8 tabSPISel[NUM_SPI_DEV] = {0, 0, CTR1_SEL, 0, CTR3_SEL};
+//const uint8 tabSPISel[NUM_SPI_DEV] = {0, 0, 0, 0, 0}; //DEBUG
+const BPDevice tabSPIDev[NUM_SPI_DEV] = {
+    {Pin_Sel2_Pwr_Write, POW_HEAD, SPI_BUFFER_SIZE},
+    {Pin_Sel3_J16_Write, PHA_HEAD, SPI_BUFFER_SIZE}, //slots in the order of the old header table, check the wiring before polling them
+    {Pin_Sel12_J17_Write, CTR1_HEAD, SPI_BUFFER_SIZE},
+    {Pin_Sel13_J18_Write, TKR_HEAD, SPI_BUFFER_SIZE},
+    {Pin_Sel7_J20_Write, CTR3_HEAD, SPI_BUFFER_SIZE},
+    {Pin_Sel5_HV1_Write, HV1_HEAD, SPI_BUFFER_SIZE_HV},
+    {Pin_Sel6_HV2_Write, HV2_HEAD, SPI_BUFFER_SIZE_HV}};
+uint8 buffSPIPool[SPI_POOL_SIZE];
+uint8 * buffSPI[NUM_SPI_DEV]; //buffSPI of each board in buffSPIPool
+SPIBufferIndex buffSPIRead[NUM_SPI_DEV];
+volatile SPIBufferIndex buffSPIWrite[NUM_SPI_DEV]; //written by ISRReadSPI while reading out, by ISRTickBP otherwise
+SPIBufferIndex buffSPICurHead[NUM_SPI_DEV]; //Header of the current packet
+SPIBufferIndex buffSPICompleteHead[NUM_SPI_DEV]; //Header of the latest complete packet
+
+PacketLocation packetFIFO[PACKET_FIFO_SIZE];
+uint8 packetFIFOHead = 0u;
+volatile uint8 packetFIFOTail = 0u; //written by ISRTickBP
+
+//const uint8 continueReadFlags = (SPIM_BP_STS_SPI_IDLE | SPIM_BP_STS_TX_FIFO_EMPTY);
+volatile uint8 continueRead = FALSE;
+
+enum readStatus readStatusBP = CHECKDATA;
+BPSchedule bpSchedule[NUM_SPI_DEV] = {
+    {BP_SELECT_LOW_US, BP_POLL_US},
+    {BP_SELECT_LOW_US, 0}, {BP_SELECT_LOW_US, 0}, {BP_SELECT_LOW_US, 0}, {BP_SELECT_LOW_US, 0},
+    {BP_SELECT_LOW_US, 0}, {BP_SELECT_LOW_US, 0}}; //select low then poll time of each board in tabSPIDev. Only the power boards are polled, the J16-J20 wiring and the HV heads are not checked yet, command 0x4B turns the others on
+volatile uint32 bpTicks = 0; //ISRTickBP ticks since InitBackplane
+uint32 bpLowTick[NUM_SPI_DEV]; //bpTicks when each board was last selected low
+uint32 bpNextDue = 0; //bpTicks when the next board is due, no board is looked at before
+uint32 bpPollTick = 0; //bpTicks when iSPIDev was selected high
+uint8 bpPolling = FALSE; //iSPIDev is selected high
+static volatile uint32 bpTickStep = 1; //bpTicks the next SysTick interrupt stands for, more while the period is stretched
+static uint32 bpTickGone = 0; //bus clocks of the tick already gone when the period was stretched
+
+/**
+ * @brief Places the buffSPI of each board in buffSPIPool and empties them
+ */
+void InitBackplaneBuffers()
+{
+    uint8 * pool = buffSPIPool;
+    for (uint8 i = 0; i < NUM_SPI_DEV; i++)
+    {
+        buffSPI[i] = pool;
+        pool += tabSPIDev[i].size;
+        buffSPIRead[i] = buffSPIWrite[i] = buffSPICurHead[i] = buffSPICompleteHead[i] = 0;
+    }
+}
+
+/**
+ * @brief Finds the board after iSPIDev that has been low for its lowUs, round robin among the boards due
+ * @details Only called once bpNextDue is reached, when none is due bpNextDue moves to the earliest board,
+ * so the ticks in between cost nothing whatever the number of boards.
+ * @return uint8 the board to poll, NUM_SPI_DEV if none is due
+ */
+static uint8 NextBackplaneDevice()
+{
+    uint8 dev = iSPIDev;
+    uint32 nextDue = bpTicks + BP_US_TO_TICKS(BP_SELECT_LOW_US); //look again in a while if no board is polled
+    for (uint8 i = 0; i < NUM_SPI_DEV; i++)
+    {
+        dev = WRAPINC(dev, NUM_SPI_DEV);
+        if (0u == bpSchedule[dev].pollUs) continue;
+        uint32 due = bpLowTick[dev] + BP_US_TO_TICKS(bpSchedule[dev].lowUs);
+        if ((int32)(bpTicks - due) >= 0) return dev;
+        if ((int32)(nextDue - due) > 0) nextDue = due;
+    }
+    bpNextDue = nextDue;
+    return NUM_SPI_DEV;
+}
+
+/**
+ * @brief Sets the time a board is polled with select high for nDrdy, ISRTickBP uses it from its next look at the board
+ * @param dev board in tabSPIDev
+ * @param pollUs poll time, 0 the board is not polled
+ * @return int 0, -EINVAL no such board
+ */
+int SetBackplanePoll(uint8 dev, uint16 pollUs)
+{
+    if (NUM_SPI_DEV <= dev)
+    {
+        cntCmdError++;
+        return -EINVAL;
+    }
+    bpSchedule[dev].pollUs = pollUs;
+    return 0;
+}
+
+/**
+ * @brief Ticks in which ISRTickBP has nothing to do, up to bpNextDue when no board is polled or read out
+ * @return uint32 ticks, 0 when the next tick has work
+ */
+uint32 BackplaneIdleTicks()
+{
+    if ((CHECKDATA != readStatusBP) || (TRUE == bpPolling)) return 0;
+    int32 left = (int32)(bpNextDue - bpTicks);
+    return (0 < left) ? (uint32)left : 0;
+}
+
+/**
+ * @brief Stretches the SysTick period to ticks BP_TICK_US, with the interrupts masked before a WFI
+ * @details The part of the tick already gone is taken off, so the period still ends on a tick.
+ * ISRTickBP counts all of them and goes back to BP_TICK_US, EndBackplaneStretch does if another
+ * interrupt ends the WFI first. A tick whose ISRTickBP has not run yet is left alone.
+ * @return uint8 TRUE if the period was stretched
+ */
+uint8 StretchBackplaneTick(uint32 ticks)
+{
+    if (0u != CySysTickGetCountFlag()) return FALSE; //ISRTickBP is pending
+    ticks = MIN(ticks, BP_TICK_STRETCH_MAX);
+    uint32 gone = (BP_TICK_CYCLES - 1u) - CySysTickGetValue();
+    CySysTickSetReload((ticks * BP_TICK_CYCLES) - 1u - gone);
+    CySysTickClear();
+    bpTickGone = gone;
+    bpTickStep = ticks;
+    return TRUE;
+}
+
+/**
+ * @brief Counts the ticks gone in a stretched period another interrupt cut short, SysTick then runs on from there
+ * @details Called with the interrupts masked after the WFI. Up to a few bus clocks a stretch are lost, ISRTickBP
+ * loses its entry time when it ends a stretch.
+ */
+void EndBackplaneStretch()
+{
+    if (1u == bpTickStep) return; //ISRTickBP ended it
+    uint32 value = CySysTickGetValue();
+    if (0u != CySysTickGetCountFlag()) return; //ISRTickBP is pending and counts the whole stretch
+    uint32 gone = bpTickGone + (CySysTickGetReload() - value);
+    uint32 ticks = gone / BP_TICK_CYCLES;
+    bpTicks += ticks;
+    bpTickStep = 1;
+    CySysTickSetReload((BP_TICK_CYCLES - 1u) - (gone - (ticks * BP_TICK_CYCLES))); //rest of the tick, ISRTickBP sets BP_TICK_CYCLES again
+    CySysTickClear();
+}
+
+/**
+ * @brief Starts SysTick pacing ISRTickBP every BP_TICK_US, with the board select lines low
+ * @details SysTick is set to the priority of isr_R so ISRTickBP and ISRReadSPI never preempt each other.
+ */
+void InitBackplane()
+{
+    readStatusBP = CHECKDATA;
+    bpTicks = bpNextDue = 0;
+    bpPolling = FALSE;
+    for (uint8 i = 0; i < NUM_SPI_DEV; i++)
+    {
+        (*tabSPIDev[i].select)(0u);
+        bpLowTick[i] = 0;
+    }
+    CySysTickStart();
+    CySysTickSetClockSource(CY_SYS_SYST_CSR_CLK_SRC_SYSCLK);
+    bpTickStep = 1;
+    CySysTickSetReload(BP_TICK_CYCLES - 1u);
+    CySysTickClear();
+    NVIC_SetPriority(SysTick_IRQn, isr_R__INTC_PRIOR_NUM);
+    CySysTickSetCallback(0u, ISRTickBP);
+}
+
+/**
+ * @brief Backplane readout state machine, one step every BP_TICK_US from SysTick
+ * @details Select line low/high phases follow bpSchedule in ticks, so the poll rate does not depend on
+ * the main loop. With no board selected high nothing is done until bpNextDue, then the board due is
+ * selected high and polled for nDrdy until its pollUs is up. The readout bytes are still paced by
+ * Timer_SelLow and ISRWriteSPI / ISRReadSPI.
+ * The finished packets go to packetFIFO for the main loop, packetFIFOTail is stored after the packet.
+ * After a stretched or cut short period it counts the ticks StretchBackplaneTick set and restarts SysTick
+ * at BP_TICK_US.
+ */
+CY_ISR(ISRTickBP)
+{
+    (void)CySysTickGetCountFlag(); //read clears it, set again means this ISR is pending
+    bpTicks += bpTickStep;
+    if ((1u != bpTickStep) || ((BP_TICK_CYCLES - 1u) != CySysTickGetReload()))
+    {
+        bpTickStep = 1;
+        CySysTickSetReload(BP_TICK_CYCLES - 1u);
+        CySysTickClear();
+    }
+	switch (readStatusBP)
+	{
+        uint8 tempnDrdy;
+		case CHECKDATA:
+
+			Timer_SelLow_Stop();
+            tempnDrdy = Pin_nDrdy_Filter_Read();
+            if (FALSE == bpPolling)
+            {
+                if ((int32)(bpTicks - bpNextDue) < 0) break; //no board due yet
+                uint8 tempDev = NextBackplaneDevice();
+                if (NUM_SPI_DEV != tempDev)
+                {
+                    iSPIDev = tempDev;
+                    (*tabSPIDev[iSPIDev].select)(1u);//select high to check the selected board, nDrdy is read from the next tick
+                    bpPollTick = bpTicks;
+                    bpPolling = TRUE;
+                }
+            }
+            else if (0u == tempnDrdy) 
+            {
+                SPIBufferIndex size = tabSPIDev[iSPIDev].size;
+                SPIBufferIndex tempBuffWrite = buffSPIWrite[iSPIDev];
+                Control_Reg_LoadPulse_Write(0x01u);
+                buffSPICurHead[iSPIDev] = buffSPIWrite[iSPIDev];
+                buffSPIWrite[iSPIDev] = RING_ADD(tempBuffWrite, 3, size);
+                if (0u != (SPIM_BP_STS_TX_FIFO_EMPTY | SPIM_BP_TX_STATUS_REG))
+                {
+                    SPIM_BP_WriteTxData(FILLBYTE);
+                }
+
+                buffSPI[iSPIDev][tempBuffWrite] = tabSPIDev[iSPIDev].head;
+                tempBuffWrite=RING_INC(tempBuffWrite, size);
+                if((size - 1) == tempBuffWrite) //check for 2 byte wrap
+                {
+                    buffSPI[iSPIDev][(size - 1)] = frame00FF[0];
+                    buffSPI[iSPIDev][0] = frame00FF[1];
+                }
+                else
+                {
+                    memcpy(&(buffSPI[iSPIDev][tempBuffWrite]), frame00FF, 2);
+                }
+
+                continueRead = TRUE; 
+                readStatusBP = READOUTDATA;
+            }
+            else if (BP_US_TO_TICKS(bpSchedule[iSPIDev].pollUs) <= (bpTicks - bpPollTick)) //timeout, no data
+            {
+                (*tabSPIDev[iSPIDev].select)(0u);//select low, polled again after its lowUs
+                bpLowTick[iSPIDev] = bpTicks;
+                bpPolling = FALSE;
+                bpNextDue = bpTicks;
+            }
+			break;
+
+		case READOUTDATA:
+			//TODO actually check 3 byte EOR, count errrors 
+//				Control_Reg_CD_Write(0u);
+//				if (TRUE == continueRead)
+//				{
+//					//if (continueReadFlags == (continueReadFlags | SPIM_BP_TX_STATUS_REG))
+//					if ((0u != (SPIM_BP_STS_SPI_IDLE | SPIM_BP_TX_STATUS_REG)))
+//					{
+//						if (0u != (SPIM_BP_STS_TX_FIFO_EMPTY | SPIM_BP_TX_STATUS_REG))
+//						{
+//							if (0x0005 == ++tempSpinTimer)
+//							{
+//								SPIM_BP_WriteTxData(FILLBYTE);
+//								tempSpinTimer = 0;
+//							}
+//							
+//						}
+//					}
+//				}
+//				if (0u == (0x03u & Control_Reg_CD_Read()))
+//                if((FALSE == continueRead) && (0u == (Timer_SelLow_ReadControlRegister() & Timer_SelLow_CTRL_ENABLE )))
+            if((FALSE == continueRead) && (0u == (Timer_SelLow_CONTROL & Timer_SelLow_CTRL_ENABLE )))
+			{
+//                    Control_Reg_CD_Write(0u);
+				if (buffSPICurHead[iSPIDev] == buffSPIWrite[iSPIDev]) //TODO this should't be true due to ISR
+				{
+
+//						uint8 nBytes = SPI_BUFFER_SIZE - buffSPIRead[iSPIDev];
+//						
+//						
+//						memcpy((buffUsbTx + iBuffUsbTx), &(buffSPI[iSPIDev][buffSPIRead[iSPIDev]]), nBytes);
+//						iBuffUsbTx += nBytes;
+//						if (nBytes < SPI_BUFFER_SIZE)
+//						{
+//							nBytes = SPI_BUFFER_SIZE - nBytes;
+//							memcpy((buffUsbTx + iBuffUsbTx), &(buffSPI[iSPIDev][0]), nBytes);
+//							iBuffUsbTx += nBytes;
+//						}
+					readStatusBP = EORERROR;
+				}
+				//if ((1u == Pin_nDrdy_Read()) && (0u != (SPIM_BP_STS_SPI_IDLE | SPIM_BP_TX_STATUS_REG)))
+				else
+				{
+					SPIBufferIndex size = tabSPIDev[iSPIDev].size;
+					SPIBufferIndex tempBuffWrite = buffSPIWrite[iSPIDev]; //ISRReadSPI is done with this board
+					RING_CONSUME();
+					int16 tempLen = tempBuffWrite - buffSPICurHead[iSPIDev];
+
+//						uint8 nBytes;
+
+                    if (0 > tempLen) tempLen += size;
+
+                    tempLen %= 3; //bytes over 3 byte alignment
+
+                    if (tempLen) tempLen = 3 - tempLen; //check if not 3 byte aligned, then calculate number of padding bytes
+
+                    int16 tempLeft = buffSPIRead[iSPIDev] - tempBuffWrite;
+                    if (0 > tempLeft) tempLeft += size;
+
+                    if (tempLeft < (tempLen + 3))
+                    {
+                        readStatusBP = EORERROR;
+                    }
+                    else 
+                    {
+                        if (tempLen)
+                        {
+                            while (tempLen--)
+                            {
+                                buffSPI[iSPIDev][tempBuffWrite] = 0; //pad 0
+                                tempBuffWrite = RING_INC(tempBuffWrite, size);
+                            }
+                            //buffSPIWrite[iSPIDev] = tempBuffWrite;
+                        }
+						buffSPIWrite[iSPIDev] = RING_ADD(tempBuffWrite, 3, size);
+						buffSPI[iSPIDev][tempBuffWrite] = EOR_HEAD;
+						tempBuffWrite = RING_INC(tempBuffWrite, size);
+						if((size - 1) == tempBuffWrite) //check for 2 byte wrap
+						{
+							buffSPI[iSPIDev][(size - 1)] = frame00FF[0];
+							buffSPI[iSPIDev][0] = frame00FF[1];
+//    							tempBuffWrite = 1;
+						}
+						else
+						{
+							memcpy(&(buffSPI[iSPIDev][tempBuffWrite]), frame00FF, 2); //Copy 0x00FF
+//    							tempBuffWrite += 1; 
+						}
+
+						packetFIFO[packetFIFOTail].header = buffSPICompleteHead[iSPIDev] = buffSPICurHead[iSPIDev];
+						packetFIFO[packetFIFOTail].index = iSPIDev;
+                        if (buffSPIWrite[iSPIDev])
+                        {
+						    packetFIFO[packetFIFOTail].EOR = buffSPIWrite[iSPIDev] - 1;
+                        }
+                        else
+                        {
+						    packetFIFO[packetFIFOTail].EOR = size - 1;
+                        }
+						RING_PUBLISH();
+						packetFIFOTail = RING_INC(packetFIFOTail, PACKET_FIFO_SIZE);
+                        loopEvent[LOOP_EV_FRAME] = TRUE;
+//						buffUsbTxDebug[iBuffUsbTxDebug++] = '|';
+//						buffUsbTxDebug[iBuffUsbTxDebug++] = iSPIDev;
+//						buffUsbTxDebug[iBuffUsbTxDebug++] = '[';
+//						buffUsbTxDebug[iBuffUsbTxDebug++] = buffSPICurHead[iSPIDev];
+//						buffUsbTxDebug[iBuffUsbTxDebug++] = '-';
+//						buffUsbTxDebug[iBuffUsbTxDebug++] = tempBuffWrite;
+//						buffUsbTxDebug[iBuffUsbTxDebug++] = ']';
+
+
+
+//						buffSPI[iSPIDev][tempBuffWrite] = 0x00;
+//						tempBuffWrite = WRAPINC(tempBuffWrite, SPI_BUFFER_SIZE);
+//						buffSPI[iSPIDev][tempBuffWrite] = 0xFF;
+//						tempBuffWrite = WRAPINC(tempBuffWrite, SPI_BUFFER_SIZE);
+//						if (buffSPIRead[iSPIDev] >= tempBuffWrite)
+//						{
+//							nBytes = SPI_BUFFER_SIZE - buffSPIRead[iSPIDev];
+//							memcpy((buffUsbTx + iBuffUsbTx), &(buffSPI[iSPIDev][buffSPIRead[iSPIDev]]), nBytes);
+//							iBuffUsbTx += nBytes;
+//							buffSPIRead[iSPIDev] = 0;
+//						}
+//						nBytes = tempBuffWrite - buffSPIRead[iSPIDev];
+//						memcpy((buffUsbTx + iBuffUsbTx), &(buffSPI[iSPIDev][buffSPIRead[iSPIDev]]), nBytes);
+//						iBuffUsbTx += nBytes;
+//						buffSPIRead[iSPIDev] = tempBuffWrite;
+						readStatusBP = EORFOUND;
+                    }
+				}
+
+			}
+            //TODO timeout
+//				else 
+//				{
+//					if (0u != (SPIM_BP_STS_SPI_IDLE | SPIM_BP_TX_STATUS_REG))
+//					{
+//						if (0x0FFFu == ++tempSpinTimer)
+//						{
+//							readStatusBP = EORERROR;
+//						}
+//					}
+//					else
+//					{
+//						tempSpinTimer = 0;
+//					}
+//				}
+			break;
+
+		case EORERROR:
+            cntError++;
+		case EORFOUND:  
+//				Control_Reg_CD_Write(0u);
+            (*tabSPIDev[iSPIDev].select)(0u);//select low to make sure
+			continueRead = FALSE; 
+
+//                continueRead = TRUE;
+//				if(0u != (Timer_SelLow_ReadControlRegister() & Timer_SelLow_CTRL_ENABLE ))
+//				{
+				Timer_SelLow_Stop();
+//				}
+//				if (0u != (SPIM_BP_STS_SPI_IDLE | SPIM_BP_TX_STATUS_REG))
+//				{
+				if (0) //(0u !=(SPIM_BP_STS_RX_FIFO_NOT_EMPTY & SPIM_BP_ReadStatus())) //TODO this shouldnt happen Readout any further bytes
+				{   
+					SPIM_BP_ReadRxData();
+//						uint8 tempBuffWrite = buffSPIWrite[iSPIDev];
+//						buffSPIWrite[iSPIDev] = WRAPINC(tempBuffWrite, SPI_BUFFER_SIZE);
+//						buffSPI[iSPIDev][tempBuffWrite] = SPIM_BP_ReadRxData();
+//						buffUsbTx[iBuffUsbTx++] = buffSPI[iSPIDev][tempBuffWrite];
+
+				}
+				else
+				{
+//						if (buffSPIRead[iSPIDev] != buffSPIWrite[iSPIDev])
+//						{
+//							uint8 tempBuffWrite = buffSPIWrite[iSPIDev];
+//					
+//							uint8 nBytes;
+//							
+//							if (buffSPIRead[iSPIDev] >= tempBuffWrite)
+//							{
+//								nBytes = SPI_BUFFER_SIZE - buffSPIRead[iSPIDev];
+//								memcpy((buffUsbTx + iBuffUsbTx), &(buffSPI[iSPIDev][buffSPIRead[iSPIDev]]), nBytes);
+//								iBuffUsbTx += nBytes;
+//								buffSPIRead[iSPIDev] = 0;
+//							}
+//							nBytes = tempBuffWrite - buffSPIRead[iSPIDev];
+//							memcpy((buffUsbTx + iBuffUsbTx), &(buffSPI[iSPIDev][buffSPIRead[iSPIDev]]), nBytes);
+//							iBuffUsbTx += nBytes;
+//							buffSPIRead[iSPIDev] = tempBuffWrite;
+//						}
+//						Control_Reg_SS_Write(tabSPISel[iSPIDev]);
+//						Control_Reg_CD_Write(1u);
+//						(*tabSPISel[iSPIDev])(1u);//select high to check the selected board
+					bpLowTick[iSPIDev] = bpTicks; //selected low above, polled again after its lowUs
+					bpPolling = FALSE;
+					bpNextDue = bpTicks;
+//						lastDrdyCap = Timer_Drdy_ReadPeriod();
+
+//						Timer_Drdy_Start();
+					readStatusBP = CHECKDATA;
+				}
+//				}
+			break;
+	}
+}
+CY_ISR(ISRReadSPI)
+{
+    uint32 traceStart = TRACE_START();
+//	if (iCmdBuff < CMDBUFFSIZE - 1)
+//	{
+//		SPIM_BP_WriteTxData(cmdBuff[iCmdBuff++]);
+//	}
+//	else if (!Pin_nDrdy_Read())
+//	{
+//		iCmdBuff = CMDBUFFSIZE - 1;
+//		SPIM_BP_WriteTxData(cmdBuff[iCmdBuff]);
+//	}
+//	uint8 tempStatus = SPIM_BP_ReadStatus();
+	uint8 tempnDrdy = Pin_nDrdy_Filter_Read();
+	SPIBufferIndex tempBuffWrite = buffSPIWrite[iSPIDev];
+	SPIBufferIndex size = tabSPIDev[iSPIDev].size;
+//	uint8 tempStatus = SPIM_BP_ReadStatus();
+	uint8 tempStatus = SPIM_BP_ReadTxStatus();
+//	Control_Reg_LoadPulse_Write(0x01);
+    (*tabSPIDev[iSPIDev].select)(0u);//select low for a period of time
+    Timer_SelLow_Start();
+    continueRead = TRUE;
+	if (tempBuffWrite != buffSPICurHead[iSPIDev]) //Check if buffer is full
+	{
+		SPIBufferIndex tempBuffNext = RING_INC(tempBuffWrite, size);
+		 //if ((0u == Pin_nDrdy_Read()) && (0u != (SPIM_BP_TX_STATUS_REG & SPIM_BP_STS_TX_FIFO_EMPTY)) && (buffSPIWrite[iSPIDev] != buffSPIRead[iSPIDev]))
+//	    uint8 tempnDrdy = Pin_nDrdy_Filter_Read(); //placed here in hopes the glith filter can change to 1 at end of data
+		if ((0u != tempnDrdy) || ((RING_ADD(tempBuffNext, 3, size)) == buffSPIRead[iSPIDev]))
+//		if ((buffSPIWrite[iSPIDev] == buffSPIRead[iSPIDev]))
+		{
+			continueRead = FALSE;
+//			Control_Reg_CD_Write(0x00u);
+//			SPIM_BP_ClearTxBuffer();
+		}
+//		else 
+//		{
+//			Control_Reg_CD_Write(0x02u);
+//			Timer_SelLow_Start();
+//			if (0u != (SPIM_BP_STS_TX_FIFO_EMPTY & tempStatus))
+//			{
+//				SPIM_BP_WriteTxData(FILLBYTE);
+//			}
+//		}
+//		tempStatus = SPIM_BP_ReadStatus();
+		tempStatus = SPIM_BP_ReadRxStatus(); //need to check RxStatus before ReadRxData()
+		if (0u != (SPIM_BP_STS_RX_FIFO_NOT_EMPTY & tempStatus))
+		{
+			buffSPI[iSPIDev][tempBuffWrite] = SPIM_BP_ReadRxData();
+		}
+		RING_PUBLISH();
+		buffSPIWrite[iSPIDev] = tempBuffNext; //after the byte so ISRTickBP never sees a slot not filled yet
+	}
+	else 
+	{
+        cntError++;
+        //TODO Error hadling
+//		Control_Reg_CD_Write(0x00u);
+        continueRead = FALSE;
+//		SPIM_BP_ClearTxBuffer();
+//		tempStatus = SPIM_BP_ReadStatus();
+	}
+    TRACE_END(TRACE_ISR_READ_SPI, traceStart);
+}
+CY_ISR(ISRWriteSPI)
+{
+	Timer_SelLow_ReadStatusRegister(); //clears the interrupt
+//	if (0u != (SPIM_BP_STS_TX_FIFO_EMPTY & SPIM_BP_TX_STATUS_REG))
+//	{
+//		SPIM_BP_WriteTxData(FILLBYTE);
+//	}
+//    (*tabSPISel[iSPIDev])(1u);//select high to check the selected board
+    if(continueRead)
+    {
+        Control_Reg_LoadPulse_Write(0x01);
+        SPIM_BP_WriteTxData(FILLBYTE);
+        (*tabSPIDev[iSPIDev].select)(1u);//select high to check the selected board
+//        Control_Reg_CD_Write(0x02u);
+
+    }
+//    else
+//    {
+//        Control_Reg_CD_Write(0x00u);
+//    }
+//	if(0u != (Timer_SelLow_ReadControlRegister() & Timer_SelLow_CTRL_ENABLE ))
+//	{
+    Timer_SelLow_Stop();
+//	}
+}
+//CY_ISR(ISRDrdyCap)
+//{
+//	uint8 intState = CyEnterCriticalSection();
+//	uint8 tempStatus = Timer_Drdy_ReadStatusRegister();
+//	
+//	if ((0u != (tempStatus & Timer_Drdy_STATUS_CAPTURE)) && (0u != (tempStatus & Timer_Drdy_STATUS_FIFONEMP)))
+//	{
+//		uint8 tempCap;
+//		while(0u != (Timer_Drdy_ReadStatusRegister() & Timer_Drdy_STATUS_FIFONEMP))
+//		{
+//			tempCap = Timer_Drdy_ReadCapture();
+//			if (0u == Pin_nDrdy_Read())
+//			{
+//				lastDrdyCap = tempCap;
+//			}
+//		}
+//	}
+//	if (0u != (tempStatus & Timer_Drdy_STATUS_TC))
+//	{
+////		if ((0u != Pin_nDrdy_Read()) || (lastDrdyCap < MIN_DRDY_CYCLES))
+////		{
+//			timeoutDrdy = TRUE;
+//			lastDrdyCap = Timer_Drdy_ReadPeriod();
+////		}
+////		else
+////		{
+////			Timer_Drdy_WriteCounter(Timer_Drdy_ReadPeriod());
+////		if(0u != (Timer_Drdy_ReadControlRegister() & Timer_Drdy_CTRL_ENABLE ))
+////		{
+////			Timer_Drdy_Stop();
+////		}
+////			Timer_Drdy_Start();
+////		}
+//		
+//	}
+//	CyExitCriticalSection(intState);
+//}
+
+/* [] END OF FILE */
@@ -0,0 +1,1082 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Command handling for the Main PSOC: low rate command uplink parsing, the
+ * per source command queues, forwarding to the Event PSOC over UART_Cmd and
+ * interpretation of commands addressed to the Main PSOC.
+ * ISRCheckCmd only moves the UART_LR_Cmd_1 / _2 RX FIFO bytes into the
+ * buffLRCmdRx ring of the port, CheckLRCmd parses them in the main loop a
+ * contiguous span at a time. Every producer of buffCmd then runs in the main
+ * loop, and the ring could as well be filled by a DMA channel on the port.
+ * UART_Cmd carries the legacy triplicated ASCII line of one command, or once
+ * command 0x44 selects it binary frames of up to CMD_FRAME_MAX commands. The
+ * Event PSOC has no way to answer on UART_Cmd, so the switch is told to it as
+ * a command in the old format and the new format starts right after.
+ * Sends are encoded into the buffCmdTx ring as long as a whole line or frame
+ * fits, and UART_Cmd_TXISR_ExitCallback feeds the UART_Cmd FIFO from it each
+ * time the TX interrupt finds the FIFO empty. The 29 byte UART_Cmd software TX
+ * buffer is left empty, so several lines are queued without a main loop pass
+ * between them.
+ * The init commands are not queued in buffCmd, initCmdPos walks initCmd in
+ * flash and they are sent ahead of the source 0 queue in its orderBuffCmd turn.
+ *
+ * ========================================
+*/
+
+#include "daq.h"
+
+enum commandStatus commandStatusC[COMMAND_SOURCES];
+uint8 commandLenC[COMMAND_SOURCES];//current command packet length expected from each source
+uint8 commandPosC[COMMAND_SOURCES];//command bytes of the packet received, they go in buffCmd past writeBuffCmd until the ETX
+uint8 commandSumC[COMMAND_SOURCES];//byte sum from len on of a batched command packet
+uint8 commandWriteC[COMMAND_SOURCES];//writeBuffCmd when the packet started, if it moves the packet is dropped
+uint8 curCmd[COMMAND_CHARS+1]; //one extra char for null
+
+//;AESOPLite Initialization Commands
+//HiVol	FDB	$A735  ;T1 1431.6 High Voltage
+//	FDB	$DD36  ;T2 1860.7
+//	FDB	$CA37  ;T3 1704.7
+//	FDB	$B9B5  ;T4 1553.3
+//	FDB	$CB74  ;G  1706.8
+//DiscP	FDB	$0039  ;Dual PHA card 0, All PHA Discriminators set to 7.0
+//	FDB	$073A  ;T1
+//	FDB	$0039  ;Dual PHA card 0
+//	FDB	$0778  ;T2
+//	FDB	$0139  ;Dual PHA card 1
+//	FDB	$073A  ;T3
+//	FDB	$0139  ;Dual PHA card 1
+//	FDB	$0778  ;T4
+//	FDB	$0239  ;Dual PHA card 2
+//	FDB	$073A  ;G	
+//	FDB	$0239  ;Dual PHA card 2
+//	FDB	$0778  ;No Input
+//DiscL	FDB	$0039  ;Dual PHA card 0, All Logic Discriminators set to 7.0
+//	FDB	$073B  ;T1
+//	FDB	$0039  ;Dual PHA card 0
+//	FDB	$0779  ;T2
+//	FDB	$0139  ;Dual PHA card 1
+//	FDB	$073B  ;T3
+//	FDB	$0139  ;Dual PHA card 1
+//	FDB	$0779  ;T4
+//	FDB	$0239  ;Dual PHA card 2
+//	FDB	$073B  ;G
+//	FDB	$0239  ;Dual PHA card 2
+//	FDB	$0779  ;No Input
+//Coinc	FDB	$F838  ;T1 T2 T3 Coincidence
+//	FDB	$0AB7  ;10sec counter R/O
+//	FDB	$0AB6  ;10sec Power R/O
+//#define TESTTHRESHOLD 0x04 //Just for intializing T3 G DAC thresholds
+//#define TESTTHRESHOLDT1 0x04 //Just for intializing T1 DAC thresholds
+//#define TESTTHRESHOLDT4 0x03 //Just for intializing T4 DAC threshold
+
+//AESOPLite Initialization Commands
+const uint8 initCmd[NUMBER_INIT_CMDS][2] = {
+    //Event PSOC DAQ Trigger Setup
+	{0x04, 0x23},  //Header for ToF DAC Threshold Set
+	{0x01, 0x21},  //Channel ToF 1 
+	{0x00, 0x22},  //DAC Byte MSB
+	{0x18, 0x23},  //24 DAC Byte LSB
+    {0x04, 0x23},  //Header for ToF DAC Threshold Set
+	{0x02, 0x21},  //Channel ToF 2
+	{0x00, 0x22},  //DAC Byte MSB
+	{0x18, 0x23},  //24 DAC Byte LSB
+    {0x01, 0x23},  //Header for DAC Threshold Set
+	{0x05, 0x21},  //Channel 5 T2
+	{0x00, 0x22},  //DAC Byte MSB
+	{0x1E, 0x23},  //30 DAC Byte LSB
+    {0x01, 0x22},  //Header for DAC Threshold Set
+	{0x01, 0x21},  //Channel 1 G
+	{0x08, 0x22},  //8 DAC Byte
+    {0x01, 0x22},  //Header for DAC Threshold Set
+	{0x02, 0x21},  //Channel 2 T3
+	{0x04, 0x22},  //4 DAC Byte
+    {0x01, 0x22},  //Header for DAC Threshold Set
+	{0x03, 0x21},  //Channel 3 T1
+	{0x08, 0x22},  //8 DAC Byte
+    {0x01, 0x22},  //Header for DAC Threshold Set
+	{0x04, 0x21},  //Channel 4 T4
+	{0x08, 0x22},  //8 DAC Byte    
+    {0x36, 0x22},  //Header for Trigger Mask Set
+	{0x01, 0x21},  //1 Mask Primary 
+	{0x01, 0x22},  //Trigger Mask 01 T1 T2 T3
+    {0x36, 0x22},  //Header for Trigger Mask Set
+    {0x02, 0x21},  //2 Mask Secondary 
+	{0x05, 0x22},  //Trigger Mask 05 T1 T3
+    {0x39, 0x22},  //Header for Trigger Prescale Set
+    {0x01, 0x21},  //1 Tracker
+	{0xFF, 0x22},  //Prescale by 255 
+    {0x39, 0x22},  //Header for Trigger Prescale Set
+    {0x02, 0x21},  //2 PMT
+	{0xFF, 0x22},  //Prescale by 255     
+    {0x4F, 0x21},  //Header for PMT Tracker Trigger Delay Set
+	{0x0C, 0x21},  //12 cycle delay 
+	{0x63, 0x21},  //Header for tracker trigger OR versus AND Set 
+	{0x00, 0x21},   //Set to AND both sides of trigger
+    //Event PSOC Tracker Setup
+	{0x10, 0x23},  //Header for Tracker command
+	{0x00, 0x21},  //0 ID
+	{0x04, 0x22},  //Reset FPGA
+	{0x00, 0x23},  //0 data bytes
+    {0x10, 0x23},  //Header for Tracker command
+	{0x01, 0x21},  //1 ID
+	{0x04, 0x22},  //Reset FPGA
+	{0x00, 0x23},  //0 data bytes
+    {0x10, 0x23},  //Header for Tracker command
+	{0x02, 0x21},  //2 ID
+	{0x04, 0x22},  //Reset FPGA
+	{0x00, 0x23},  //0 data bytes
+    {0x10, 0x23},  //Header for Tracker command
+	{0x03, 0x21},  //3 ID
+	{0x04, 0x22},  //Reset FPGA
+	{0x00, 0x23},  //0 data bytes
+    {0x10, 0x23},  //Header for Tracker command
+	{0x04, 0x21},  //4 ID
+	{0x04, 0x22},  //Reset FPGA
+	{0x00, 0x23},  //0 data bytes
+    {0x10, 0x23},  //Header for Tracker command
+	{0x05, 0x21},  //5 ID
+	{0x04, 0x22},  //Reset FPGA
+	{0x00, 0x23},  //0 data bytes
+    {0x10, 0x23},  //Header for Tracker command
+	{0x06, 0x21},  //6 ID
+	{0x04, 0x22},  //Reset FPGA
+	{0x00, 0x23},  //0 data bytes
+    {0x10, 0x23},  //Header for Tracker command
+	{0x07, 0x21},  //7 ID
+	{0x04, 0x22},  //Reset FPGA
+	{0x00, 0x23},  //0 data bytes
+    {0x10, 0x23},  //Header for Tracker command
+	{0x00, 0x21},  //0 ID
+	{0x03, 0x22},  //Reset Config
+	{0x00, 0x23},  //0 data bytes
+    {0x10, 0x23},  //Header for Tracker command
+	{0x01, 0x21},  //1 ID
+	{0x03, 0x22},  //Reset Config
+	{0x00, 0x23},  //0 data bytes
+    {0x10, 0x23},  //Header for Tracker command
+	{0x02, 0x21},  //2 ID
+	{0x03, 0x22},  //Reset Config
+	{0x00, 0x23},  //0 data bytes
+    {0x10, 0x23},  //Header for Tracker command
+	{0x03, 0x21},  //3 ID
+	{0x03, 0x22},  //Reset Config
+	{0x00, 0x23},  //0 data bytes
+    {0x10, 0x23},  //Header for Tracker command
+	{0x04, 0x21},  //4 ID
+	{0x03, 0x22},  //Reset Config
+	{0x00, 0x23},  //0 data bytes
+    {0x10, 0x23},  //Header for Tracker command
+	{0x05, 0x21},  //5 ID
+	{0x03, 0x22},  //Reset Config
+	{0x00, 0x23},  //0 data bytes
+    {0x10, 0x23},  //Header for Tracker command
+	{0x06, 0x21},  //6 ID
+	{0x03, 0x22},  //Reset Config
+	{0x00, 0x23},  //0 data bytes
+    {0x10, 0x23},  //Header for Tracker command
+	{0x07, 0x21},  //7 ID
+	{0x03, 0x22},  //Reset Config
+	{0x00, 0x23},  //0 data bytes
+    {0x10, 0x61},  //Header for Tracker command
+	{0x00, 0x21},  //0 ID
+	{0x06, 0x22},  //Set Trigger Delay
+	{0x02, 0x23},  //2 data bytes
+    {0x00, 0x60},  //0 Delay Cycles
+    {0x00, 0x61},  //0 Stretch
+    {0x59, 0xA0},  //Header for Tracker Layer Map command
+	{0x02, 0x21},  //Tracker C
+	{0x07, 0x22},  //Tracker H
+	{0x01, 0x23},  //Tracker B
+    {0x00, 0x60},  //Tracker A
+    {0x04, 0x61},  //Tracker E
+    {0x05, 0x62},  //Tracker F
+    {0x06, 0x63},  //Tracker G
+    {0x03, 0xA0},  //Tracker D
+    {0x5B, 0xA0},  //Header for Tracker Threshold Increase command. Only gets loaded by 0x56 command 
+	{0x03, 0x21},  //Increase L0 tracker threshold by 6
+	{0x03, 0x22},  //Increase L1 tracker threshold by 6
+	{0x06, 0x23},  //Increase L2 tracker threshold by 6
+	{0x06, 0x60},  //Increase L3 tracker threshold by 6
+	{0x00, 0x61},  //Increase L4 tracker threshold by 6
+	{0x00, 0x62},  //Increase L5 tracker threshold by 6
+	{0x00, 0x63},  //Increase L6 tracker threshold by 6
+	{0x00, 0xA0},  //Increase L7 tracker threshold by 6
+    {0x56, 0x21},  //Header for Tracker ASIC Power On & Config command. This command takes time so prefer not to issue an Event PSOC command after
+	{0x08, 0x21},  //8 Layers. This command takes time so prefer not to issue an Event PSOC command after
+    //HV Control Board Setup. Placed here to prevent Event PSOC command following 0x56 command 
+	{0xAF, 0x35}, //T1 1500V High Voltage
+	{0xCC, 0x36}, //T2 1718V High Voltage
+	{0xC6, 0x37}, //T3 1671V High Voltage
+	{0xBF, 0xB5}, //T4 1603V High Voltage
+	{0xDD, 0x74}, //G  1858V High Voltage
+    //Event PSOC Housekeeping Setup + Auto Start Run and Error List
+    {0x57, 0x22},  //Header for Event PSOC Housekeeping command
+	{0x05, 0x21},  //5 sec Rate
+	{0x01, 0x22},  //1 Include Tracker Rate
+    {0x5C, 0x21},  //Header for Event PSOC Tracker Housekeeping command
+	{0x05, 0x21},  //5 min Rate
+    {0x3C, 0x60},  //Header for Start Run
+	{0x00, 0x21},  //0 Run Number MSB
+	{0x01, 0x22},  //1 Run Number LSB
+	{0x01, 0x23},  //Include Tracks
+    {0x00, 0x60},  //Exclude ToF Debug Data
+    {0x03, 0x20},  //Header For Read Errors. Init errors proir to this will be sent & cleared
+	//Startup FPGA Input Timing Calibration
+//    {0x48, 0x21},  //Header for FPGA Input Timing Calibration Obsolete in v100 tracker firmware
+//	{0x08, 0x21},  //All FPGA. This command takes time so prefer not to issue an Event PSOC command after
+    //Power Board Setup. Placed here to prevent a newly issued Event PSOC command from following 0x48 command 
+	{0x0A, 0xB6},  //10sec Power Readout
+    }; //End init cmds
+uint8 buffCmd[COMMAND_SOURCES][CMD_BUFFER_SIZE][2];// circular buffer of commands from all sources 
+uint8 readBuffCmd[COMMAND_SOURCES];//read indices for all command sources 
+volatile uint8 writeBuffCmd[COMMAND_SOURCES];//write indices for all command sources
+uint8 orderBuffCmd[COMMAND_SOURCES];//priority order for the command sources
+uint8 headerBuffCmd[COMMAND_SOURCES];//Header of command being interpreted if any
+uint8 interpretBuffCmd[COMMAND_SOURCES];//Next byte of command being interpreted if any
+uint8 lastCmdSource = 0;//last command sources to send a command
+uint8 initCmdPos = NUMBER_INIT_CMDS;//next init command to send, NUMBER_INIT_CMDS all sent
+volatile uint16 cntCmd = 0;//count of commands recieved (not sent)
+uint8 cntCmdError = 0;//count of command errors
+enum cmdLinkFormat cmdLinkFormat = CMD_LINK_ASCII;//format UART_Cmd is sending in
+enum cmdLinkFormat cmdLinkRequest = CMD_LINK_ASCII;//format asked for by command 0x44, the Event PSOC is told before cmdLinkFormat changes
+static const uint8 hexChars[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+uint8 cmdLine[CMD_LINE_SIZE] = "S0000 01WS0000 01WS0000 01W\r\n";//legacy command line, START_COMMAND 4 chars END_COMMAND 3 times then CR LF. Only the chars are rewritten
+uint8 buffCmdTx[CMD_TX_SIZE]; //encoded lines and frames waiting for UART_Cmd
+volatile uint8 buffCmdTxRead = 0; //written by the UART_Cmd TX interrupt
+volatile uint8 buffCmdTxWrite = 0;
+uint8 buffLRCmdRx[LR_CMD_PORTS][LR_CMD_RX_SIZE]; //ground command bytes of UART_LR_Cmd_1 / _2 waiting for CheckLRCmd
+volatile uint8 buffLRCmdRxRead[LR_CMD_PORTS];
+volatile uint8 buffLRCmdRxWrite[LR_CMD_PORTS]; //written by ISRCheckCmd
+volatile uint16 cntLRCmdRxLost[LR_CMD_PORTS]; //bytes ISRCheckCmd dropped on a full ring, written by ISRCheckCmd
+static uint16 cntLRCmdRxLostSeen[LR_CMD_PORTS]; //cntLRCmdRxLost when CheckLRCmd last looked
+
+/**
+ * @brief Checks that len bytes fit in buffCmdTx
+ */
+static uint8 CmdTxRoom(uint8 len)
+{
+    return (RING_FREE(buffCmdTxRead, buffCmdTxWrite, CMD_TX_SIZE) >= len) ? TRUE : FALSE;
+}
+
+/**
+ * @brief Queues len encoded bytes for UART_Cmd, the caller checked CmdTxRoom
+ * @details Raising the TX interrupt starts the wire when it was idle, while sending the
+ * callback only tops up the FIFO.
+ */
+static void CmdTxPut(const uint8 * data, uint8 len)
+{
+    uint8 tmpWrite = buffCmdTxWrite;
+    for (uint8 x = 0; x < len; x++)
+    {
+        buffCmdTx[tmpWrite] = data[x];
+        tmpWrite = RING_INC(tmpWrite, CMD_TX_SIZE);
+    }
+    RING_PUBLISH();
+    buffCmdTxWrite = tmpWrite;
+    UART_Cmd_SetPendingTxInt();
+}
+
+/**
+ * @brief Moves buffCmdTx bytes into the UART_Cmd FIFO until it is full, at the end of the TX interrupt
+ * @details The component TX buffer is never used, so PutChar writes straight to the FIFO.
+ */
+void UART_Cmd_TXISR_ExitCallback()
+{
+    uint8 tmpWrite = buffCmdTxWrite;
+    RING_CONSUME();
+    uint8 tmpRead = buffCmdTxRead;
+    while ((tmpRead != tmpWrite) && (0u == (UART_Cmd_ReadTxStatus() & UART_Cmd_TX_STS_FIFO_FULL)))
+    {
+        UART_Cmd_PutChar(buffCmdTx[tmpRead]);
+        tmpRead = RING_INC(tmpRead, CMD_TX_SIZE);
+    }
+    buffCmdTxRead = tmpRead;
+}
+
+/*******************************************************************************
+* Function Name: CmdBytes2String
+********************************************************************************
+*
+* Summary:
+*  Converts a 2 byte command in binary to a 4 byte ASCII representation of that 
+*  command (null terminator is the 5th byte).  
+*
+* Parameters:
+*  in:  uint8 pointer to 2 bytes to be converted 
+*  out: uint8 pointer to 5 byte null terminted string of the result of 
+*  2byte command converted to capitalized ASCII hexadecimal characters   
+*  
+* Return:
+*  int number of charaters returned. Should be 4 on success, negative on fault
+*
+*******************************************************************************/
+int CmdBytes2String (uint8* in, uint8* out)
+{
+    if ((NULL == in) || (NULL == out)) //check for null pointers
+    {
+        cntError++;
+        return -EFAULT; //null pointer error
+    }
+    out[0] = hexChars[in[0] >> 4]; //capitalized hex with leading zeros, same as "%02X%02X"
+    out[1] = hexChars[in[0] & 0x0F];
+    out[2] = hexChars[in[1] >> 4];
+    out[3] = hexChars[in[1] & 0x0F];
+    out[COMMAND_CHARS] = 0;
+	return COMMAND_CHARS;
+}
+
+/**
+ * @brief Writes the 4 hex chars of the command in (data byte, address byte) into the 3 copies in cmdLine
+ */
+void EncodeCmdLine(const uint8 * in)
+{
+    uint8 c0 = hexChars[in[0] >> 4];
+    uint8 c1 = hexChars[in[0] & 0x0F];
+    uint8 c2 = hexChars[in[1] >> 4];
+    uint8 c3 = hexChars[in[1] & 0x0F];
+    for (uint8 x = START_COMMAND_SIZE; x < (CMD_LINE_SIZE - 2); x += CMD_LINE_REPEAT_SIZE)
+    {
+        cmdLine[x] = c0;
+        cmdLine[x + 1] = c1;
+        cmdLine[x + 2] = c2;
+        cmdLine[x + 3] = c3;
+    }
+}
+
+/**
+ * @brief Queues the command in (data byte, address byte) as the legacy ASCII line for UART_Cmd
+ * @return int 0 on success, -EBUSY if the line does not fit in buffCmdTx yet
+ */
+int SendCmdLine(const uint8 * in)
+{
+	if (FALSE == CmdTxRoom(CMD_LINE_SIZE)) return -EBUSY; // Not ready to send 
+    EncodeCmdLine(in);
+    CmdTxPut(cmdLine, CMD_LINE_SIZE);
+	return 0;
+}
+
+/**
+ * @brief Queues the 4 ASCII command chars in as the legacy ASCII line for UART_Cmd
+ * @return int 0 on success, -EBUSY if the line does not fit in buffCmdTx yet
+ */
+int SendCmdString (uint8 * in)
+{
+	if (FALSE == CmdTxRoom(CMD_LINE_SIZE)) return -EBUSY; // Not ready to send 
+    for (uint8 x = START_COMMAND_SIZE; x < (CMD_LINE_SIZE - 2); x += CMD_LINE_REPEAT_SIZE)
+    {
+        memcpy(&cmdLine[x], in, COMMAND_CHARS);
+    }
+    CmdTxPut(cmdLine, CMD_LINE_SIZE);
+	return 0;
+}
+
+/**
+ * @brief Asks for the UART_Cmd format, CheckCmdBuffers tells the Event PSOC and switches before the next command
+ * @param format enum cmdLinkFormat
+ * @return int 0 on success, -EINVAL for an unknown format
+ */
+int SetCmdLinkFormat(uint8 format)
+{
+    if (CMD_LINK_BINARY < format)
+    {
+        cntCmdError++;
+        return -EINVAL;
+    }
+    cmdLinkRequest = format;
+    return 0;
+}
+
+/**
+ * @brief Sends the command in in (data byte, address byte) in the current UART_Cmd format, the caller checked CmdTxRoom
+ */
+static void SendCmdLink(uint8 * in)
+{
+    if (CMD_LINK_BINARY == cmdLinkFormat)
+    {
+        uint8 frame[CMD_FRAME_OVERHEAD + 2] = {CMD_FRAME_SYNC, 1, in[0], in[1], 0};
+        frame[4] = -(1 + in[0] + in[1]);
+        CmdTxPut(frame, sizeof(frame));
+        return;
+    }
+    SendCmdLine(in);
+}
+
+/**
+ * @brief Sends up to CMD_FRAME_MAX queued commands as one binary frame, taking them in orderBuffCmd priority like one at a time would
+ * @return int number of commands sent
+ */
+static int SendCmdFrame()
+{
+    uint8 frame[CMD_FRAME_OVERHEAD + (2 * CMD_FRAME_MAX)];
+    uint8 n = 0;
+    uint8 sum = 0;
+    for (uint8 i = 0; (i < COMMAND_SOURCES) && (CMD_FRAME_MAX > n); i++)
+    {
+        uint8 curChan = orderBuffCmd[i];
+        while ((0 == curChan) && (NUMBER_INIT_CMDS > initCmdPos) && (CMD_FRAME_MAX > n)) //init commands go ahead of the source 0 queue
+        {
+            frame[2 + (2 * n)] = initCmd[initCmdPos][0];
+            frame[3 + (2 * n)] = initCmd[initCmdPos][1];
+            sum += initCmd[initCmdPos][0] + initCmd[initCmdPos][1];
+            initCmdPos++;
+            n++;
+        }
+        uint8 tmpWrite = writeBuffCmd[curChan];
+        RING_CONSUME();
+        uint8 tmpRead = readBuffCmd[curChan];
+        while ((tmpRead != tmpWrite) && (CMD_FRAME_MAX > n))
+        {
+            frame[2 + (2 * n)] = buffCmd[curChan][tmpRead][0];
+            frame[3 + (2 * n)] = buffCmd[curChan][tmpRead][1];
+            sum += buffCmd[curChan][tmpRead][0] + buffCmd[curChan][tmpRead][1];
+            tmpRead = RING_INC(tmpRead, CMD_BUFFER_SIZE);
+            n++;
+        }
+        readBuffCmd[curChan] = tmpRead;
+    }
+    if (0 == n) return 0;
+    frame[0] = CMD_FRAME_SYNC;
+    frame[1] = n;
+    frame[2 + (2 * n)] = -(sum + n);
+    CmdTxPut(frame, CMD_FRAME_OVERHEAD + (2 * n));
+    return n;
+}
+
+/**
+ * @brief Starts sending the init commands, over from the first if they were still going out
+ * @details CheckCmdBuffers takes them straight from initCmd, so no buffCmd space is needed and
+ * the other sources keep their orderBuffCmd turns while they go out.
+ * @return int NUMBER_INIT_CMDS
+ */
+int SendInitCmds()
+{
+    initCmdPos = 0;
+    loopEvent[LOOP_EV_CMD] = TRUE;
+    return NUMBER_INIT_CMDS;
+}
+
+/**
+ * @brief Runs the low rate command packet parser of source i on the next byte
+ * @details The command bytes go straight into buffCmd past writeBuffCmd, the whole packet is
+ * queued at the ETX (and the checksum for a batch). Another producer queueing to the source
+ * in the middle of a packet moves writeBuffCmd, the packet is dropped then.
+ * @return int 0, negative is errno for a dropped packet
+ */
+int ParseCmdInputByte(uint8 tempRx, uint8 i)
+{
+    switch(commandStatusC[i])
+    {
+        case WAIT_DLE:
+            if (DLE == tempRx) commandStatusC[i] = CHECK_ID;
+            break;
+        case CHECK_ID:
+            if (CMD_ID == tempRx) commandStatusC[i] = CHECK_LEN;
+            else if (REQ_ID == tempRx) commandStatusC[i] = CHECK_ETX_REQ;
+            else 
+            {
+                commandStatusC[i] = WAIT_DLE;
+                cntCmdError++;
+                return -EIDRM;
+            }
+            break;
+        case CHECK_LEN:
+            if ((2 != tempRx) && ((CMD_BATCH_MIN_LEN > tempRx) || (0 != (tempRx & 1))))
+            {
+                commandStatusC[i] = WAIT_DLE;
+                cntCmdError++;
+                return -E2BIG;
+            }
+            if ((tempRx >> 1) > RING_FREE(readBuffCmd[i], writeBuffCmd[i], CMD_BUFFER_SIZE))
+            {
+                commandStatusC[i] = WAIT_DLE;
+                cntCmdError++;
+                return -ENOMEM;
+            }
+            commandLenC[i] = tempRx;
+            commandPosC[i] = 0;
+            commandSumC[i] = tempRx;
+            commandWriteC[i] = writeBuffCmd[i];
+            commandStatusC[i] = READ_CMD;
+            break;
+        case READ_CMD:
+            buffCmd[i][RING_ADD(writeBuffCmd[i], commandPosC[i] >> 1, CMD_BUFFER_SIZE)][commandPosC[i] & 1] = tempRx; //data byte then address byte
+            commandSumC[i] += tempRx;
+            commandPosC[i]++;
+            if (commandLenC[i] == commandPosC[i])
+            {
+                commandStatusC[i] = (2 == commandLenC[i]) ? CHECK_ETX_CMD : CHECK_SUM;
+            }
+            break;
+        case CHECK_SUM:
+            commandStatusC[i] = WAIT_DLE;
+            if (0 != (uint8)(commandSumC[i] + tempRx))
+            {
+                cntCmdError++;
+                return -EBADMSG;
+            }
+            commandStatusC[i] = CHECK_ETX_CMD;
+            break;
+        case CHECK_ETX_CMD:
+            commandStatusC[i] = WAIT_DLE;
+            if ((ETX != tempRx) || (commandPosC[i] != commandLenC[i]))
+            {
+                cntCmdError++;
+                return -EILSEQ;
+            }
+            uint8 tempWrite = writeBuffCmd[i];
+            if (commandWriteC[i] != tempWrite) //commands queued by another task took the place of the first bytes
+            {
+                cntCmdError++;
+                return -EAGAIN;
+            }
+            uint8 tempNum = commandLenC[i] >> 1;
+            for (uint8 x = 0; x < tempNum; x++)
+            {
+                uint8 * tempCmd = buffCmd[i][RING_ADD(tempWrite, x, CMD_BUFFER_SIZE)];
+                if ((0x47 == tempCmd[0]) && (CMD_MAIN_PSOC_ADDRESS == tempCmd[1])) // 0x4728 is reset command, done as it is queued ahead of the interpreter. A hung main loop is reset by the watchdog (LOOP_WDT)
+                {
+                    CySoftwareReset(); //software reset
+                }
+            }
+            RING_PUBLISH();
+            writeBuffCmd[i] = RING_ADD(tempWrite, tempNum, CMD_BUFFER_SIZE);
+            loopEvent[LOOP_EV_CMD] = TRUE;
+            cntCmd += tempNum;
+            lastCmdSource = i; //store last command source
+            break;
+        case CHECK_ETX_REQ:
+            if (ETX == tempRx)
+            {
+//                SendLRScienceData();
+                lowRateReq = TRUE;
+            }
+            else 
+            {
+                cntCmdError++;
+                //TODO error
+                return -EILSEQ;
+            }
+            commandStatusC[i] = WAIT_DLE;
+            break;
+    }
+    return 0;
+}
+
+/**
+ * @brief Forwards the queued commands to the Event PSOC on UART_Cmd while they fit in buffCmdTx
+ * @details ASCII lines or binary frames of up to CMD_FRAME_MAX commands are queued behind the one sending,
+ * taken in orderBuffCmd priority at the time they are queued. A format change asked for by
+ * SetCmdLinkFormat goes out first, in the old format.
+ * @return int number of commands sent, -EBUSY if buffCmdTx had no room for any
+ */
+int CheckCmdBuffers()
+{
+    int nSent = 0;
+    for (;;)
+    {
+        if (FALSE == CmdTxRoom((CMD_LINK_BINARY == cmdLinkFormat) ? (CMD_FRAME_OVERHEAD + (2 * CMD_FRAME_MAX)) : CMD_LINE_SIZE))
+        {
+            return (0 == nSent) ? -EBUSY : nSent; // Not ready to send
+        }
+        if (cmdLinkRequest != cmdLinkFormat)
+        {
+            uint8 tmpCmd[2] = {(CMD_LINK_BINARY == cmdLinkRequest) ? CMD_EVENT_LINK_BINARY : CMD_EVENT_LINK_ASCII, CMD_EVENT_ADDRESS};
+            SendCmdLink(tmpCmd);
+            cmdLinkFormat = cmdLinkRequest;
+            continue;
+        }
+        int tmpSent = 0;
+        if (CMD_LINK_BINARY == cmdLinkFormat)
+        {
+            tmpSent = SendCmdFrame();
+        }
+        else
+        {
+            for (uint8 i = 0; i < COMMAND_SOURCES; i++) 
+            {
+                uint8 curChan = orderBuffCmd[i];
+                if ((0 == curChan) && (NUMBER_INIT_CMDS > initCmdPos)) //init commands go ahead of the source 0 queue
+                {
+                    SendCmdLine(initCmd[initCmdPos]);
+                    initCmdPos++;
+                    tmpSent = 1;
+                    break;
+                }
+                if (readBuffCmd[curChan] != writeBuffCmd[curChan]) // check if q has cmd
+                {
+                    RING_CONSUME();
+                    SendCmdLine(buffCmd[curChan][readBuffCmd[curChan]]);
+                    readBuffCmd[curChan] = RING_INC(readBuffCmd[curChan], CMD_BUFFER_SIZE);
+                    tmpSent = 1;
+                    break;
+                }
+            }
+        }
+        if (0 == tmpSent) return nSent;
+        nSent += tmpSent;
+    }
+}
+
+static int MainCmdHKPeriod(uint8 cmdID, const uint8 * data, uint8 numDataBytes)
+{
+    hkSecs = cmdID & 0x0F;
+    return 0;
+}
+
+static int MainCmdRTCFlags(uint8 cmdID, const uint8 * data, uint8 numDataBytes)
+{
+    rtcStatus |= cmdID & 0x0F;
+    return 0;
+}
+
+static int MainCmdClearCounters(uint8 cmdID, const uint8 * data, uint8 numDataBytes)
+{
+    cntError = 0;
+    cntCmdError = 0;
+    cntFramesDropped = 0;
+    cntFramesDroppedUSB = 0;
+    memset(frameSchedWaitPeak, 0, sizeof(frameSchedWaitPeak));
+    return 0;
+}
+
+static int MainCmdBusyThres(uint8 cmdID, const uint8 * data, uint8 numDataBytes)
+{
+    outputBusyLowThres = data[0] % 99;
+    outputBusyHighThres = data[1] % 99;
+    if (0 == outputBusyHighThres)
+    {
+        outputBusyHighThres = 1;
+    }
+    if (outputBusyLowThres > outputBusyHighThres)
+    {
+        outputBusyHighThres = outputBusyLowThres;
+    }
+    return 0;
+}
+
+static int MainCmdFrameSched(uint8 cmdID, const uint8 * data, uint8 numDataBytes) //quantum in frames of Event, backplane, HK then the max wait in frames
+{
+    for (uint8 src = 0; src < FRAME_SOURCES; src++)
+    {
+        frameSchedQuantum[src] = MAX(data[src], 1); //0 would never send
+    }
+    frameSchedMaxWait = data[FRAME_SOURCES];
+    return 0;
+}
+
+static int MainCmdLoopBudget(uint8 cmdID, const uint8 * data, uint8 numDataBytes) //main loop budget in us MSB, LSB, then the passes in a row the low priority tasks can be put off
+{
+    SetLoopBudget(((uint16)data[0] << 8) | data[1], data[2]);
+    return 0;
+}
+
+static int MainCmdLinkFormat(uint8 cmdID, const uint8 * data, uint8 numDataBytes)
+{
+    return SetCmdLinkFormat(data[0]);
+}
+
+static int MainCmdSetRTC(uint8 cmdID, const uint8 * data, uint8 numDataBytes)
+{
+    mainTimeDate.Sec = data[0] % 60;
+    mainTimeDate.Min = data[1] % 60;
+    mainTimeDate.Hour = data[2] % 24;
+    mainTimeDate.DayOfMonth = data[3] % 31;
+    mainTimeDate.Month = data[4] % 12;
+    mainTimeDate.Year = ((uint16)data[5] << 8) | data[6];
+    RTC_Main_WriteTime(&mainTimeDate);
+//            RTC_Main_Init();//Sets RTC variables DEBUG
+    return 0;
+}
+
+static int MainCmdInitRTC(uint8 cmdID, const uint8 * data, uint8 numDataBytes)
+{
+    RTC_Main_Init();
+    return 0;
+}
+
+static int MainCmdResetEvHW(uint8 cmdID, const uint8 * data, uint8 numDataBytes)
+{
+    Pin_Reset_Ev_HW_Write(0); //released by the next InterpretCmdBuffers
+    return 0;
+}
+
+static int MainCmdResetEvSW(uint8 cmdID, const uint8 * data, uint8 numDataBytes)
+{
+    Pin_Reset_Ev_SW_Write(1); //released by the next InterpretCmdBuffers
+    return 0;
+}
+
+static int MainCmdInitCmds(uint8 cmdID, const uint8 * data, uint8 numDataBytes)
+{
+    SendInitCmds();
+    return 0;
+}
+
+static int MainCmdBPPoll(uint8 cmdID, const uint8 * data, uint8 numDataBytes) //board in tabSPIDev then the poll time in us MSB, LSB
+{
+    return SetBackplanePoll(data[0], ((uint16)data[1] << 8) | data[2]);
+}
+
+static int MainCmdI2CRetries(uint8 cmdID, const uint8 * data, uint8 numDataBytes)
+{
+    I2CMaxRetries = cmdID & 0x03; //set I2CMaxRetries 0-3 default 1
+    return 0;
+}
+
+static int MainCmdMacroBegin(uint8 cmdID, const uint8 * data, uint8 numDataBytes)
+{
+    return BeginCmdMacro(data[0]);
+}
+
+static int MainCmdMacroAppend(uint8 cmdID, const uint8 * data, uint8 numDataBytes)
+{
+    return AppendCmdMacro(data, numDataBytes);
+}
+
+static int MainCmdMacroSave(uint8 cmdID, const uint8 * data, uint8 numDataBytes)
+{
+    return SaveCmdMacro();
+}
+
+static int MainCmdMacroRun(uint8 cmdID, const uint8 * data, uint8 numDataBytes)
+{
+    return RunCmdMacro(cmdID - CMD_MACRO_RUN_ID);
+}
+
+static const MainCmd tabMainCmd[MAIN_CMDS] = {
+    [MAIN_CMD_NONE] = {NULL, 0},
+    [MAIN_CMD_HK_PERIOD] = {MainCmdHKPeriod, 0},
+    [MAIN_CMD_RTC_FLAGS] = {MainCmdRTCFlags, 0},
+    [MAIN_CMD_CLEAR_COUNTERS] = {MainCmdClearCounters, 0},
+    [MAIN_CMD_BUSY_THRES] = {MainCmdBusyThres, 2},
+    [MAIN_CMD_FRAME_SCHED] = {MainCmdFrameSched, FRAME_SOURCES + 1},
+    [MAIN_CMD_LOOP_BUDGET] = {MainCmdLoopBudget, 3},
+    [MAIN_CMD_LINK_FORMAT] = {MainCmdLinkFormat, 1},
+    [MAIN_CMD_SET_RTC] = {MainCmdSetRTC, 7},
+    [MAIN_CMD_INIT_RTC] = {MainCmdInitRTC, 0},
+    [MAIN_CMD_RESET_EV_HW] = {MainCmdResetEvHW, 0},
+    [MAIN_CMD_RESET_EV_SW] = {MainCmdResetEvSW, 0},
+    [MAIN_CMD_INIT_CMDS] = {MainCmdInitCmds, 0},
+    [MAIN_CMD_BP_POLL] = {MainCmdBPPoll, 3},
+    [MAIN_CMD_I2C_RETRIES] = {MainCmdI2CRetries, 0},
+    [MAIN_CMD_MACRO_BEGIN] = {MainCmdMacroBegin, 1},
+    [MAIN_CMD_MACRO_APPEND] = {MainCmdMacroAppend, MAIN_CMD_DATA_UP_TO | (CMD_MAIN_MAX_DATA - 1)},
+    [MAIN_CMD_MACRO_SAVE] = {MainCmdMacroSave, 0},
+    [MAIN_CMD_MACRO_RUN] = {MainCmdMacroRun, 0}}; //handler and data bytes of each Main PSOC command
+
+static const uint8 tabMainCmdSlot[256] = {
+    [0x01 ... 0x0F] = MAIN_CMD_HK_PERIOD,
+    [0x31 ... 0x3F] = MAIN_CMD_RTC_FLAGS,
+    [0x40] = MAIN_CMD_CLEAR_COUNTERS,
+    [0x41] = MAIN_CMD_BUSY_THRES,
+    [0x42] = MAIN_CMD_FRAME_SCHED,
+    [0x43] = MAIN_CMD_LOOP_BUDGET,
+    [0x44] = MAIN_CMD_LINK_FORMAT,
+    [0x45] = MAIN_CMD_SET_RTC,
+    [0x46] = MAIN_CMD_INIT_RTC,
+    //0x47 is software reset main which completes in ISR
+    [0x48] = MAIN_CMD_RESET_EV_HW,
+    [0x49] = MAIN_CMD_RESET_EV_SW,
+    [0x4A] = MAIN_CMD_INIT_CMDS,
+    [0x4B] = MAIN_CMD_BP_POLL,
+    [0x50 ... 0x53] = MAIN_CMD_I2C_RETRIES,
+    [0x54] = MAIN_CMD_MACRO_BEGIN,
+    [0x55] = MAIN_CMD_MACRO_APPEND,
+    [0x56] = MAIN_CMD_MACRO_SAVE,
+    [CMD_MACRO_RUN_ID ... (CMD_MACRO_RUN_ID + CMD_MACROS - 1)] = MAIN_CMD_MACRO_RUN}; //tabMainCmd entry of each command ID, MAIN_CMD_NONE is not a Main PSOC command
+
+/**
+ * @brief Frames the next complete Main PSOC command of a command source, stepping over the commands to the other PSOCs
+ * @details The command is headerBuffCmd up to interpretBuffCmd (exclusive). Data-byte command n must have the address
+ * byte CMD_MAIN_BYTE_ADDRESS(n), the command ends at the one matching the header address. A command still missing
+ * data-byte commands is resumed at interpretBuffCmd on the next call, so each byte is checked once.
+ * @return int data-byte commands of the framed command, -EAGAIN nothing complete yet, -EILSEQ bad sequence (skipped)
+ */
+static int FrameMainCmd(uint8 chan)
+{
+    uint8 tmpWrite = writeBuffCmd[chan]; //the parsers can move this during the call
+    RING_CONSUME();
+    for(;;)
+    {
+        uint8 cur = interpretBuffCmd[chan];
+        if (cur == tmpWrite) return -EAGAIN;
+        uint8 curAdr = buffCmd[chan][cur][1];
+        uint8 header = headerBuffCmd[chan];
+        interpretBuffCmd[chan] = RING_INC(cur, CMD_BUFFER_SIZE);
+        if (header == cur)
+        {
+            if (CMD_MAIN_PSOC_ADDRESS != (curAdr & CMD_ADDRESS_MASK))
+            {
+                headerBuffCmd[chan] = interpretBuffCmd[chan]; //for another PSOC, CheckCmdBuffers sends it
+            }
+            else if (0 == (curAdr & CMD_NUM_BYTE_MASK))
+            {
+                return 0;
+            }
+            continue;
+        }
+        uint8 numDataBytes = RING_LEN(header, cur, CMD_BUFFER_SIZE);
+        if (CMD_MAIN_BYTE_ADDRESS(numDataBytes) != curAdr)
+        {
+            headerBuffCmd[chan] = interpretBuffCmd[chan] = cur; //could be the next header
+            cntCmdError++;
+            return -EILSEQ;
+        }
+        if (curAdr == buffCmd[chan][header][1]) return numDataBytes; //end of multibyte command
+    }
+}
+
+/**
+ * @brief Executes the Main PSOC command FrameMainCmd framed and moves headerBuffCmd past it
+ * @return int 0 or negative errno
+ */
+static int ExecMainCmd(uint8 chan, uint8 numDataBytes)
+{
+    uint8 header = headerBuffCmd[chan];
+    uint8 cmdID = buffCmd[chan][header][0];
+    uint8 data[CMD_MAIN_MAX_DATA];
+    for (uint8 x = 0; x < numDataBytes; x++)
+    {
+        header = RING_INC(header, CMD_BUFFER_SIZE);
+        data[x] = buffCmd[chan][header][0];
+    }
+    headerBuffCmd[chan] = interpretBuffCmd[chan];
+    const MainCmd * cmd = &tabMainCmd[tabMainCmdSlot[cmdID]];
+    if (NULL == cmd->run)
+    {
+        cntCmdError++;
+        return -ENXIO;
+    }
+    uint8 maxData = cmd->dataBytes & ~MAIN_CMD_DATA_UP_TO;
+    uint8 minData = (0 != (cmd->dataBytes & MAIN_CMD_DATA_UP_TO)) ? 1 : maxData;
+    if ((numDataBytes < minData) || (numDataBytes > maxData))
+    {
+        cntCmdError++;
+        return -ENOEXEC;
+    }
+    return (*cmd->run)(cmdID, data, numDataBytes);
+}
+
+/**
+ * @brief Interprets commands already in buffer & executes them if addresses to Main PSOC
+ * @details Each individual Command is 2 bytes, Data Byte followed by Address Byte \n
+ - Sequence of multiple commands is used for more complex actions using the following format:
+ - 1st Data Byte: {7:0} gives the command ID                 
+ - 1st Address Byte: {7:6} and {1:0] give the number of data-byte commands to follow, 0 to 15
+ - address byte {5:2} = 0xA indicate the main PSOC
+ - All command sequence data arrive in up to 15 subsequent data-byte commands. For Each:
+ - bits {7:0} of the data byte are the data for the command in progress
+ - bits {7:6} and {1:0} of the address byte give the data-byte number, 1 through 15
+ - bits {5:2} of the address byte must match, as usual, the PSOC address of 0xA.
+ The sources are drained in orderBuffCmd order, every complete command is executed until CMD_INTERPRET_US is used.
+ The command ID picks the handler and data bytes in tabMainCmd through tabMainCmdSlot.
+ Table below Des
+ * ID | Command Data Bytes | Description
+------------- | ------------- | -------------
+0x01-0x0F  | NONE  | Sets the period (in sec) for sending Main Housekeeping Packets to the Command ID [1-15]
+0x31-0x3F  | NONE  | Sets flags for RTC date time  operations if bit is set in least signicant nibble of Command ID. Flags from Most Significant to Least Significant: [Set Main -> Event] [Set Main -> External RTC] [Set External RTC -> Main]
+0x40  | NONE | Clears the error and dropped frame counters and the frame wait peaks
+0x41  | 0: low % | Output busy thresholds of the frame buffer, high is at least low
+^ | 1: high % | ^
+0x42  | 0-2: quantum | Frame scheduler quantum in frames of Event, backplane and HK
+^ | 3: max wait | ^
+0x43  | 0: MSB us | Main loop budget, then the passes in a row the low priority tasks can be put off
+^ | 1: LSB us | ^
+^ | 2: passes | ^
+0x44  | 0: format | UART_Cmd format to the Event PSOC, 0 legacy ASCII lines, 1 binary frames. The Event PSOC is told in the old format first
+0x45  | 0: seconds | Sets the internal RTC for the Main PSOC (non persistent over power cycle)
+^ | 1: minutes | ^
+^ | 2: hours | ^
+^ | 3: day-of-month | ^
+^ | 4: month | ^
+^ | 5: MSB year | ^
+^ | 6: LSB year | ^
+0x46  | NONE | Runs the internal RTC initialization that sets day of week, day of year, and other variables 
+0x48  | NONE | Holds the Event PSOC hardware reset until the next pass
+0x49  | NONE | Holds the Event PSOC software reset until the next pass
+0x4A  | NONE | Sends the init commands to the Event PSOC again, from the first
+0x4B  | 0: board | Backplane poll time of a board in tabSPIDev, 0 power, 1 J16, 2 J17, 3 J18, 4 J20, 5 HV1, 6 HV2. 0 us stops polling it
+^ | 1: MSB us | ^
+^ | 2: LSB us | ^
+0x50-0x53  | NONE | I2C retries, 0-3 in the 2 LSB of the Command ID
+0x54  | 0: slot | Starts recording command macro slot 0-7, replaces what was recorded and not saved
+0x55  | 0-13: commands | Appends 1 to 7 commands, data byte then address byte, to the macro being recorded
+0x56  | NONE | Saves the macro recorded to its slot, kept in EEPROM over resets
+0x60-0x67  | NONE | Runs command macro slot 0-7, its commands are queued to command source 0 a few each pass
+
+
+ * @return int Number of commands executed. If none, 0 or the errno of the last one that failed
+ */
+int InterpretCmdBuffers()
+{
+    uint32 start = TRACE_NOW();
+    uint32 budget = CMD_INTERPRET_US * (BCLK__BUS_CLK__HZ / 1000000u);
+    int numCmds = 0, lastRes = 0;
+    if (0 == Pin_Reset_Ev_HW_Read())
+    {
+        Pin_Reset_Ev_HW_Write(1);
+    }
+    if (0 != Pin_Reset_Ev_SW_Read())
+    {
+        Pin_Reset_Ev_SW_Write(0);
+    }
+    for (uint8 i = 0; i < COMMAND_SOURCES; )
+    {
+        uint8 curChan = orderBuffCmd[i];
+        int tmpRes = FrameMainCmd(curChan);
+        if (-EAGAIN == tmpRes)
+        {
+            i++; //source drained, next one
+            continue;
+        }
+        if (0 <= tmpRes)
+        {
+            tmpRes = ExecMainCmd(curChan, tmpRes);
+        }
+        if (0 > tmpRes)
+        {
+            lastRes = tmpRes;
+        }
+        else
+        {
+            numCmds++;
+        }
+        if ((TRACE_NOW() - start) >= budget) break; //rest on the next pass
+    }
+    return (0 < numCmds) ? numCmds : lastRes;
+}
+
+uint8 buffUsbRx[USBUART_BUFFER_SIZE];
+uint8 iBuffUsbRx = 0;
+uint8 nBuffUsbRx = 0;
+
+/**
+ * @brief Services USB CDC enumeration and parses any commands received from the host
+ * @return int result of the last ParseCmdInputByte, negative is errno
+ */
+int CheckUSB()
+{
+    int tempRes = 0;
+	if (0u != USBUART_CD_IsConfigurationChanged())
+	{
+		/* Initialize IN endpoints when device is configured. */
+		if (0u != USBUART_CD_GetConfiguration())
+		{
+			/* Enumeration is done, enable OUT endpoint to receive data 
+			 * from host. */
+			USBUART_CD_CDC_Init();
+		}
+	}
+
+	/* Service USB CDC when device is configured. */
+	if ((nBuffUsbRx == iBuffUsbRx) && (0u != USBUART_CD_GetConfiguration()))
+	{
+		/* Check for input data from host. */
+		if (0u != USBUART_CD_DataIsReady())
+		{
+			/* Read received data and re-enable OUT endpoint. */
+			nBuffUsbRx = USBUART_CD_GetAll(buffUsbRx);
+			iBuffUsbRx = 0;
+		}
+	}
+    for(uint8 x = 0; x < nBuffUsbRx; x++)
+    {
+        tempRes = ParseCmdInputByte(buffUsbRx[x], (COMMAND_SOURCES - 1));
+        if (0 > tempRes)
+        {
+            //TODO error handling
+        }
+    }
+    iBuffUsbRx = 0;
+    nBuffUsbRx = 0;
+    return tempRes;
+}
+
+/**
+ * @brief Parses the ground command bytes ISRCheckCmd queued in buffLRCmdRx, a contiguous span at a time
+ * @details The packet a port was in when ISRCheckCmd dropped bytes is dropped as well, its parser
+ * starts over at the next DLE.
+ * @return int bytes parsed
+ */
+int CheckLRCmd()
+{
+    int n = 0;
+    for (uint8 i = 0; i < LR_CMD_PORTS; i++)
+    {
+        uint8 tmpWrite = buffLRCmdRxWrite[i];
+        RING_CONSUME();
+        uint8 tmpRead = buffLRCmdRxRead[i];
+        while (tmpRead != tmpWrite)
+        {
+            uint8 span = RING_SPAN(tmpRead, tmpWrite, LR_CMD_RX_SIZE);
+            const uint8 * tmpRx = &buffLRCmdRx[i][tmpRead];
+            for (uint8 x = 0; x < span; x++)
+            {
+                ParseCmdInputByte(tmpRx[x], i);
+            }
+            tmpRead = RING_ADD(tmpRead, span, LR_CMD_RX_SIZE);
+            n += span;
+        }
+        uint16 tmpLost = cntLRCmdRxLost[i];
+        if (cntLRCmdRxLostSeen[i] != tmpLost) //the ring was full, so the bytes lost came after all those parsed
+        {
+            cntLRCmdRxLostSeen[i] = tmpLost;
+            commandStatusC[i] = WAIT_DLE;
+            cntCmdError++;
+        }
+        buffLRCmdRxRead[i] = tmpRead;
+    }
+    return n;
+}
+
+/**
+ * @brief Moves the RX FIFO bytes of UART_LR_Cmd_1 / _2 into buffLRCmdRx and posts LOOP_EV_CMD for CheckLRCmd
+ * @details A byte that finds the ring full is counted in cntLRCmdRxLost and dropped.
+ */
+CY_ISR(ISRCheckCmd)
+{
+    UART_LR_Cmd_1_ReadRxStatus(); //clears the sticky status bits
+    UART_LR_Cmd_2_ReadRxStatus();
+    uint8 tmpWrite = buffLRCmdRxWrite[0];
+    uint8 tmpRead = buffLRCmdRxRead[0];
+    while (0u != UART_LR_Cmd_1_GetRxBufferSize())
+    {
+        uint8 tempRx = UART_LR_Cmd_1_ReadRxData();
+        if (0u == RING_FREE(tmpRead, tmpWrite, LR_CMD_RX_SIZE))
+        {
+            cntLRCmdRxLost[0]++;
+            continue;
+        }
+        buffLRCmdRx[0][tmpWrite] = tempRx;
+        tmpWrite = RING_INC(tmpWrite, LR_CMD_RX_SIZE);
+    }
+    RING_PUBLISH();
+    buffLRCmdRxWrite[0] = tmpWrite;
+
+    tmpWrite = buffLRCmdRxWrite[1];
+    tmpRead = buffLRCmdRxRead[1];
+    while (0u != UART_LR_Cmd_2_GetRxBufferSize())
+    {
+        uint8 tempRx = UART_LR_Cmd_2_ReadRxData();
+        if (0u == RING_FREE(tmpRead, tmpWrite, LR_CMD_RX_SIZE))
+        {
+            cntLRCmdRxLost[1]++;
+            continue;
+        }
+        buffLRCmdRx[1][tmpWrite] = tempRx;
+        tmpWrite = RING_INC(tmpWrite, LR_CMD_RX_SIZE);
+    }
+    RING_PUBLISH();
+    buffLRCmdRxWrite[1] = tmpWrite;
+    loopEvent[LOOP_EV_CMD] = TRUE;
+}
+
+/* [] END OF FILE */
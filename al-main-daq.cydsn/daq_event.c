@@ -0,0 +1,175 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Event PSOC data path: SPIS_Ev ingest into buffEv and framing of the Event
+ * PSOC packets into packetEv for the frame buffer.
+ *
+ * ========================================
+*/
+
+#include "daq.h"
+
+uint8 buffEv[EV_BUFFER_SIZE];
+volatile EvBufferIndex buffEvRead;
+volatile EvBufferIndex buffEvWrite;
+volatile uint16 cntEvDropped = 0; //Event bytes dropped by ISRReadEv with buffEv full
+
+PacketEvent packetEv[PACKET_EVENT_SIZE];
+uint8 packetEvHead = 0u;
+uint8 packetEvTail = 0u;
+
+enum eventFrameStatus evFrameStatus = EV_FIND_HEAD;
+EvBufferIndex evFrameStart = 0u; //first byte not queued to packetEv yet, dumped if no packet starts here
+EvBufferIndex evFrameCur = 0u; //next byte to check, the framer resumes here on the next call
+EvBufferIndex evFrameHead = 0u; //header of the packet being framed
+EvBufferIndex evFrameLen = 0u; //total bytes of the packet being framed, header to EOR inclusive
+
+/**
+ * @brief Queues the bytes from header to EOR (inclusive) for the frame buffer
+ */
+static void QueueEventPacket(EvBufferIndex header, EvBufferIndex EOR)
+{
+    packetEv[packetEvTail].header = header;
+    packetEv[packetEvTail].EOR = EOR;
+    packetEvTail = RING_INC(packetEvTail, PACKET_EVENT_SIZE);
+}
+
+/**
+ * @brief Resets the framer to the start of the unread Event data
+ */
+void InitEventFramer()
+{
+    evFrameStatus = EV_FIND_HEAD;
+    evFrameStart = evFrameCur = evFrameHead = buffEvRead;
+    evFrameLen = 0;
+}
+
+/**
+ * @brief Frames the Event PSOC packets in buffEv going forward from where the last call stopped.
+ * @details Header DB/DC, 00 FF, len for DC, then the EOR FF 00 FF is checked where the len puts it.
+ * Data bytes are not looked at, so every byte is visited at most once for well formed data.
+ * A packet not complete yet is resumed on the next call. Bytes that fail the checks are
+ * queued as a dump in front of the next packet, or once EV_MAX_SIZE of them pile up.
+ * @return int8 number of packets (including dumps) queued to packetEv
+ */
+int8 CheckEventPackets()
+{
+    int8 numPkts = 0;
+    EvBufferIndex tmpWrite = buffEvWrite; //ISRReadEv can move this during the call
+    EvBufferIndex tmpRead = buffEvRead;
+    RING_CONSUME();
+    TRACE_PEAK(TRACE_PEAK_EV, RING_LEN(tmpRead, tmpWrite, EV_BUFFER_SIZE));
+    for(;;)
+    {
+        uint8 nFree = RING_FREE(packetEvHead, packetEvTail, PACKET_EVENT_SIZE);
+        if (EV_CHECK_EOR == evFrameStatus)
+        {
+            if (evFrameLen > RING_LEN(evFrameHead, tmpWrite, EV_BUFFER_SIZE)) return numPkts; //wait for the rest of the packet
+            if (((evFrameStart != evFrameHead) ? 2 : 1) > nFree) return numPkts; //wait for packetEv space
+            EvBufferIndex curEOR = RING_WRAP(evFrameHead + evFrameLen - 3, EV_BUFFER_SIZE);
+            if ((EOR_HEAD == buffEv[curEOR]) && (frame00FF[0] == buffEv[RING_INC(curEOR, EV_BUFFER_SIZE)]) && (frame00FF[1] == buffEv[RING_ADD(curEOR, 2, EV_BUFFER_SIZE)]))
+            {
+                if (evFrameStart != evFrameHead) //dump the data that failed checks before the header
+                {
+                    QueueEventPacket(evFrameStart, RING_DEC(evFrameHead, EV_BUFFER_SIZE));
+                    numPkts++;
+                }
+                QueueEventPacket(evFrameHead, RING_ADD(curEOR, 2, EV_BUFFER_SIZE));
+                numPkts++;
+                evFrameStart = evFrameCur = RING_ADD(curEOR, 3, EV_BUFFER_SIZE);
+            }
+            else
+            {
+                evFrameCur = RING_INC(evFrameHead, EV_BUFFER_SIZE); //not a packet, search again after the false header
+            }
+            evFrameStatus = EV_FIND_HEAD;
+            continue;
+        }
+        if (evFrameCur == tmpWrite) return numPkts;
+        uint8 tmpByte = buffEv[evFrameCur];
+        switch (evFrameStatus)
+        {
+            case EV_FIND_HEAD:
+                if ((EVFIX_HEAD == tmpByte) || (EVVAR_HEAD == tmpByte))
+                {
+                    evFrameHead = evFrameCur;
+                    evFrameStatus = EV_CHECK_00;
+                }
+                else if (EV_MAX_SIZE <= RING_LEN(evFrameStart, evFrameCur, EV_BUFFER_SIZE)) //no header in a max packet of bytes, dump them
+                {
+                    if (0 == nFree) return numPkts;
+                    QueueEventPacket(evFrameStart, evFrameCur);
+                    numPkts++;
+                    evFrameStart = RING_INC(evFrameCur, EV_BUFFER_SIZE);
+                }
+                break;
+            case EV_CHECK_00:
+                evFrameStatus = (frame00FF[0] == tmpByte) ? EV_CHECK_FF : EV_FIND_HEAD;
+                if (EV_FIND_HEAD == evFrameStatus) continue; //this byte could be a header
+                break;
+            case EV_CHECK_FF:
+                if (frame00FF[1] == tmpByte)
+                {
+                    evFrameLen = EV_MIN_SIZE;
+                    evFrameStatus = (EVVAR_HEAD == buffEv[evFrameHead]) ? EV_CHECK_LEN : EV_CHECK_EOR;
+                }
+                else
+                {
+                    evFrameStatus = EV_FIND_HEAD;
+                    continue;
+                }
+                break;
+            case EV_CHECK_LEN:
+                evFrameLen = EV_MIN_SIZE + tmpByte + WRAP(3 - WRAP(tmpByte, 3), 3); //data bytes are padded to the 3 byte alignment
+                evFrameStatus = EV_CHECK_EOR;
+                break;
+            default:
+                evFrameStatus = EV_FIND_HEAD;
+                break;
+        }
+        evFrameCur = RING_INC(evFrameCur, EV_BUFFER_SIZE);
+    }
+}
+
+/**
+ * @brief Copies the SPIS_Ev FIFO into buffEv. Only producer of buffEvWrite, so no critical section.
+ * @details When buffEv is full the new bytes are dropped and counted, buffEvRead belongs to the main loop.
+ */
+CY_ISR(ISRReadEv)
+{
+    uint32 traceStart = TRACE_START();
+	EvBufferIndex tempBuffWrite = buffEvWrite;
+	EvBufferIndex tempBuffRead = buffEvRead;
+	uint8 tempStatus = SPIS_Ev_ReadStatus();
+	if (0u != (SPIS_Ev_STS_RX_BUF_NOT_EMPTY & tempStatus)) 
+	{
+        do //get all availiable bytes
+		{
+            uint8 tempData = SPIS_Ev_ReadRxData();
+            EvBufferIndex tempNext = RING_INC(tempBuffWrite, EV_BUFFER_SIZE);
+            if (tempNext != tempBuffRead)
+            {
+                buffEv[tempBuffWrite] = tempData;
+                tempBuffWrite = tempNext;
+            }
+            else
+            {
+                cntEvDropped++; //full, drop the newest byte
+            }
+		} while (SPIS_Ev_GetRxBufferSize());
+        RING_PUBLISH();
+		buffEvWrite = tempBuffWrite;
+        loopEvent[LOOP_EV_EVENT] = TRUE;
+	}
+    TRACE_END(TRACE_ISR_READ_EV, traceStart);
+}
+
+/* [] END OF FILE */
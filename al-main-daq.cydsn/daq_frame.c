@@ -0,0 +1,865 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Output frame buffer: packing of Event, backplane and housekeeping packets
+ * into FrameOutput frames and draining them to the HR UART (DMA) and USB.
+ *
+ * ========================================
+*/
+
+#include "daq.h"
+
+const uint8 frame00FF[2] = {0x00u, 0xFFu};
+enum eventLowRateCopyState eventLRCopy = COPY_EVENT_HK;//default to HK copy
+const uint8 frameSync[2] = {0x55u, 0xABu};
+uint32 frameCnt = 0u; //TODO Comment this out when ISR is removed
+
+FrameOutput buffFrameData[FRAME_BUFFER_SIZE];
+//uint8 buffFrameData[FRAME_BUFFER_SIZE][FRAME_DATA_BYTES];
+FmBufferIndex buffFrameDataRead = 0;
+FmBufferIndex buffFrameDataReadUSB = 0;
+FmBufferIndex buffFrameDataWrite = 0;
+uint8 frameFill = 0; //data bytes already in the frame at buffFrameDataWrite
+
+uint8 frameSchedQuantum[FRAME_SOURCES] = {12u, 3u, 3u}; //frames of credit a source gets each round, Event, backplane, HK
+uint8 frameSchedMaxWait = 48u; //frames others may send while a source waits before it goes next, 0 no bound
+uint8 frameSchedCur = FRAME_SRC_EVENT; //source the round is on
+int16 frameSchedDeficit[FRAME_SOURCES]; //frames of credit left this round
+uint16 frameSchedWait[FRAME_SOURCES]; //frames sent by others since the source had a packet waiting
+uint16 frameSchedWaitPeak[FRAME_SOURCES]; //high water mark of frameSchedWait
+uint8 frameSchedBound = FALSE; //last pick was forced by frameSchedMaxWait, its credit is not charged
+uint8 usbFrameOffset = 0; //bytes of usbFrameCarry already sent to USB, 0 if no frame is split
+FrameOutput usbFrameCarry; //frame split over 2 USB packets, out of buffFrameData so it can't be overwritten
+FrameUsbDesc buffFrameUsb[FRAME_USB_DESCS]; //packets framed and not sent to USB yet, in frame order
+uint8 buffFrameUsbRead = 0;
+uint8 buffFrameUsbWrite = 0;
+FmBufferIndex usbDescSent = 0; //frames of the packet at buffFrameUsbRead already sent to USB
+uint16 usbDescFrames = 0; //frames queued in buffFrameUsb and not sent yet
+uint8 usbFrameLive = FALSE; //USB configured, framed packets are queued to buffFrameUsb
+EvBufferIndex frameEvHeader = 0; //buffEv bytes of the last Event packet framed
+EvBufferIndex frameEvBytes = 0;
+uint8 usbNeedZLP = FALSE; //last packet was full size, the transfer is not ended yet
+
+uint16 seqFrame2HB = 0; //2 Highest bytes of the frame seq (seqH & seqM) the seqL is set by init
+
+uint16 cntFramesDropped = 0; // number of frames overwritten before being sent via RS232
+uint16 cntFramesDroppedUSB = 0; // number of frames overwritten before being sent via USB
+
+uint8 DMAHRDataChan = CY_DMA_INVALID_CHANNEL;
+uint8 DMAHRDataTd[DMA_HR_Data_TDS];
+uint8 DMAHRDataActive = FALSE;
+FmBufferIndex DMAHRDataStart = 0; //first frame of the run DMA_HR_Data is sending
+FmBufferIndex DMAHRDataRun = 0; //frames in the run DMA_HR_Data is sending
+reg16 * DMAHRDataSrcPtr = NULL; //working source address of DMA_HR_Data, low 16 bits
+
+FmBufferIndex InitFrameBuffer()
+{
+    FmBufferIndex initFB = 0;
+    while (FRAME_BUFFER_SIZE > initFB)
+    {
+        buffFrameData[initFB].seqL = (uint8)(initFB & 0xFF); //seqL is the LSB of the index of the Frame Buffer and doesn't need to change
+        memcpy(buffFrameData[initFB].sync, frameSync, 2);
+        memcpy((buffFrameData[initFB].sync + 2), frameSync, 2);
+        initFB++;
+        
+    }
+    frameFill = 0;
+    buffFrameUsbRead = buffFrameUsbWrite = 0;
+    usbDescSent = 0;
+    usbDescFrames = 0;
+    frameEvHeader = buffEvRead;
+    frameEvBytes = 0;
+    return initFB;
+}
+
+/**
+ * @brief Sets up DMA_HR_Data and allocates the TDs chained for a run of frames, once at startup
+ */
+void InitFrameDMA()
+{
+    DMAHRDataChan  = DMA_HR_Data_DmaInitialize(DMA_HR_Data_BYTES_PER_BURST, DMA_HR_Data_REQUEST_PER_BURST, HI16(DMA_HR_Data_SRC_BASE), HI16(DMA_HR_Data_DST_BASE)); //keep this high rate channel for UART
+    for (uint8 i = 0; i < DMA_HR_Data_TDS; i++)
+    {
+        DMAHRDataTd[i] = CyDmaTdAllocate();
+    }
+    DMAHRDataSrcPtr = (reg16 *) &CY_DMA_CFGMEM_STRUCT_PTR[DMAHRDataChan].CFG1[0u];
+    DMAHRDataActive = FALSE;
+    DMAHRDataRun = 0;
+}
+
+/**
+ * @brief Starts DMA_HR_Data on the contiguous frames from buffFrameDataRead, up to the buffer wrap or DMA_HR_Data_RUN_FRAMES
+ * @details The first byte is put in the UART to start the requests, the rest of the run is split over the chained TDs.
+ * Only the last TD has the nrq, so one Status_Reg_UART_DMA bit completes the whole run. When HR is more than
+ * FRAME_BUFFER_SIZE - DMA_HR_Data_HEADROOM frames behind, its oldest frames are dropped first.
+ */
+static void StartFrameDMA()
+{
+    FmBufferIndex behind = ACTIVELEN(buffFrameDataRead, buffFrameDataWrite, FRAME_BUFFER_SIZE);
+    if ((FRAME_BUFFER_SIZE - DMA_HR_Data_HEADROOM) < behind)
+    {
+        behind -= FRAME_BUFFER_SIZE - DMA_HR_Data_HEADROOM;
+        buffFrameDataRead = WRAP(buffFrameDataRead + behind, FRAME_BUFFER_SIZE);
+        cntFramesDropped += behind;
+    }
+    DMAHRDataStart = buffFrameDataRead;
+    DMAHRDataRun = MIN(ACTIVELEN(buffFrameDataRead, buffFrameDataWrite, FRAME_BUFFER_SIZE), FRAME_BUFFER_SIZE - buffFrameDataRead);
+    DMAHRDataRun = MIN(DMAHRDataRun, DMA_HR_Data_RUN_FRAMES);
+    uint16 nBytes = (DMAHRDataRun * sizeof(FrameOutput)) - 1; //the first byte goes out with PutChar
+    uint32 src = (uint32)&(buffFrameData[ DMAHRDataStart ].seqM);
+    uint8 i = 0;
+    for(;;)
+    {
+        uint16 n = MIN(nBytes, (DMA_HR_Data_TD_FRAMES * sizeof(FrameOutput)));
+        nBytes -= n;
+        if (0 == nBytes)
+        {
+            CyDmaTdSetConfiguration(DMAHRDataTd[i], n, DMA_DISABLE_TD, (CY_DMA_TD_INC_SRC_ADR | DMA_HR_Data__TD_TERMOUT_EN)); //last TD, nrq when the run is done
+            CyDmaTdSetAddress(DMAHRDataTd[i], LO16(src), LO16((uint32)UART_HR_Data_TXDATA_PTR));
+            break;
+        }
+        CyDmaTdSetConfiguration(DMAHRDataTd[i], n, DMAHRDataTd[i + 1], CY_DMA_TD_INC_SRC_ADR);
+        CyDmaTdSetAddress(DMAHRDataTd[i], LO16(src), LO16((uint32)UART_HR_Data_TXDATA_PTR));
+        src += n;
+        i++;
+    }
+    CyDmaChSetInitialTd(DMAHRDataChan, DMAHRDataTd[0]);//TD initialization
+
+    UART_HR_Data_ReadTxStatus(); //clear any pending interrupts
+    CyDmaClearPendingDrq(DMAHRDataChan);//clear in case there is already a drq
+    DMAHRDataActive = TRUE;
+    UART_HR_Data_PutChar((buffFrameData[ DMAHRDataStart ].seqH)); //start UART with first byte DMA will get rest
+    CyDmaChEnable(DMAHRDataChan, 0u);//Enable the DMA channel
+}
+
+/**
+ * @brief Frames of the DMA_HR_Data run already moved to the UART, they can be overwritten
+ * @details From the working source address, which is still the last run's until the first request of this run loads
+ * the TD. A stale address is before the run start or past its end, so it counts as none sent.
+ */
+static FmBufferIndex FrameDMASent()
+{
+    uint16 nBytes = CY_GET_REG16(DMAHRDataSrcPtr) - LO16((uint32)&(buffFrameData[ DMAHRDataStart ].seqM));
+    if (nBytes >= (DMAHRDataRun * sizeof(FrameOutput))) return 0;
+    return (nBytes + 1) / sizeof(FrameOutput); //seqH went out with PutChar
+}
+
+/**
+ * @brief Moves buffFrameDataWrite to the next frame, dropping the oldest frame of an output that has not sent it yet
+ * @details The oldest HR frame is not dropped while DMA_HR_Data has still to read it, then the newest frame is
+ * dropped instead and its slot is filled again.
+ */
+static void FrameAdvance()
+{
+    FmBufferIndex readInRun = ACTIVELEN(DMAHRDataStart, buffFrameDataRead, FRAME_BUFFER_SIZE);
+    if ((TRUE == DMAHRDataActive) && (WRAPINC(buffFrameDataWrite, FRAME_BUFFER_SIZE) == buffFrameDataRead)
+        && (readInRun < DMAHRDataRun) && (FrameDMASent() <= readInRun)) //next slot is in the run and not sent
+    {
+        cntFramesDropped++;
+        cntFramesDroppedUSB++; //USB never sees it either
+        frameFill = 0;
+        return;
+    }
+    if((255) == buffFrameData[ buffFrameDataWrite ].seqL )
+    {
+        seqFrame2HB++;
+    }
+    buffFrameDataWrite = WRAPINC(buffFrameDataWrite, FRAME_BUFFER_SIZE);
+    if (buffFrameDataWrite == buffFrameDataRead) //Overwrite and drop RS232 frame
+    {
+        buffFrameDataRead = WRAPINC(buffFrameDataRead, FRAME_BUFFER_SIZE);
+        cntFramesDropped++;
+    }
+#if (0u == FRAME_USB_GATHER)
+    if (buffFrameDataWrite == buffFrameDataReadUSB) //Overwrite and drop USB frame
+    {
+        buffFrameDataReadUSB = WRAPINC(buffFrameDataReadUSB, FRAME_BUFFER_SIZE);
+        cntFramesDroppedUSB++;
+    }
+#endif
+    frameFill = 0;
+}
+
+/**
+ * @brief Appends n bytes of a packet to the frames, starting a frame when the last one is full
+ * @details Copies straight into buffFrameData with 1 memcpy a frame. The seq of a frame is set when its first byte is added.
+ */
+void FrameAppend(const uint8 * src, uint16 n)
+{
+    while (0 < n)
+    {
+        if (0 == frameFill)
+        {
+            buffFrameData[ buffFrameDataWrite ].seqM =  seqFrame2HB & 0xFF; //middle seqence byte
+            buffFrameData[ buffFrameDataWrite ].seqH =  seqFrame2HB >> 8; //high seqence byte
+        }
+        uint8 nBytes = MIN(FRAME_DATA_BYTES - frameFill, n);
+        memcpy( (void*) &(buffFrameData[ buffFrameDataWrite ].data[ frameFill ]), src, nBytes);
+        frameFill += nBytes;
+        src += nBytes;
+        n -= nBytes;
+        if (FRAME_DATA_BYTES <= frameFill)
+        {
+            FrameAdvance();
+        }
+    }
+}
+
+/**
+ * @brief Pads the data of a frame filled up to fill, to the 3 byte alignment then with NULL_HEAD 00 FF
+ */
+static void FramePad(uint8 * data, uint8 fill)
+{
+    uint8 bytesAlign = WRAP(fill, 3); //calc number of bytes off 3 byte alignment
+    if (0 != bytesAlign) //check if misaligned search space
+    {
+        data[ fill++ ] = 0x00; //add padding byte to fix alignment
+        if (1 == bytesAlign)// needs 2nd padding byte
+        {
+            data[ fill++ ] = 0x00; //add padding byte to fix alignment
+        }
+    }
+    while (FRAME_DATA_BYTES > fill)
+    {
+        data[ fill++ ] = NULL_HEAD;
+        memcpy(&(data[ fill ]), frame00FF, 2);
+        fill += 2;
+    }
+}
+
+/**
+ * @brief Ends the packet, pads a part filled frame and sends it
+ */
+void FrameFlush()
+{
+    if (0 == frameFill) return;
+    FramePad(buffFrameData[ buffFrameDataWrite ].data, frameFill);
+    FrameAdvance();
+}
+
+/**
+ * @brief Copies the end of an Event HK packet in buffEv into lowRateHK.eventHK, the last sizeof(eventHK) bytes before the EOR
+ * @details At most 2 memcpy straight from buffEv, split only at the ring wrap. Done once per packet, not per frame.
+ */
+static void CopyEventHK(EvBufferIndex header, EvBufferIndex nBytes)
+{
+    EvBufferIndex curRead = header;
+    if (sizeof(lowRateHK.eventHK) < nBytes)
+    {
+        curRead = RING_ADD(header, nBytes - sizeof(lowRateHK.eventHK), EV_BUFFER_SIZE); //only the newest bytes fit
+        nBytes = sizeof(lowRateHK.eventHK);
+    }
+    EvBufferIndex nSpan = RING_SPAN(curRead, RING_ADD(curRead, nBytes, EV_BUFFER_SIZE), EV_BUFFER_SIZE);
+    nSpan = MIN(nSpan, nBytes);
+    memcpy(lowRateHK.eventHK, (buffEv + curRead), nSpan);
+    memcpy((lowRateHK.eventHK + nSpan), buffEv, nBytes - nSpan);
+}
+
+/**
+ * @brief Frames the oldest queued Event packet from buffEv
+ */
+static void FrameEventPacket()
+{
+    EvBufferIndex curRead = packetEv[ packetEvHead ].header;
+    EvBufferIndex curEOR = packetEv[ packetEvHead ].EOR;
+    EvBufferIndex nDataBytes = RING_LEN(curRead, curEOR, EV_BUFFER_SIZE) + 1;
+    packetEvHead = RING_INC(packetEvHead, PACKET_EVENT_SIZE);
+    if ((COPY_EVENT_HK == eventLRCopy) && (EV_MIN_SIZE <= nDataBytes)) //check if LR is set to HK
+    {
+        if (EVHK_ID == buffEv[RING_ADD(curRead, 4, EV_BUFFER_SIZE)])//4 byte offset from headeris ID byte
+        {
+            CopyEventHK(curRead, nDataBytes - 3); //don't copy the 3 byte EOR
+        }
+    }
+    EvBufferIndex nBytes = MIN(RING_SPAN(curRead, RING_INC(curEOR, EV_BUFFER_SIZE), EV_BUFFER_SIZE), nDataBytes); //contiguous part before the wrap
+    FrameAppend((buffEv + curRead), nBytes);
+    FrameAppend(buffEv, nDataBytes - nBytes);
+    FrameFlush();
+#if FRAME_USB_GATHER
+    frameEvHeader = curRead; //FrameUsbQueue frees the bytes once USB is done with them
+    frameEvBytes = nDataBytes;
+#else
+    buffEvRead = RING_INC(curEOR, EV_BUFFER_SIZE);
+#endif
+}
+
+/**
+ * @brief Frames the oldest backplane packet queued in packetFIFO from its buffSPI
+ */
+static void FrameBackplanePacket()
+{
+    RING_CONSUME(); //packetFIFOTail was read by FrameSourcePending
+    uint8 curSPIDev = packetFIFO[packetFIFOHead].index;
+    SPIBufferIndex size = tabSPIDev[curSPIDev].size;
+    SPIBufferIndex curRead = packetFIFO[ packetFIFOHead ].header;
+    SPIBufferIndex curEOR = packetFIFO[ packetFIFOHead ].EOR;
+    SPIBufferIndex nDataBytes = RING_LEN(curRead, curEOR, size) + 1;
+    packetFIFOHead = RING_INC(packetFIFOHead, PACKET_FIFO_SIZE);
+    SPIBufferIndex nBytes = MIN(RING_SPAN(curRead, RING_INC(curEOR, size), size), nDataBytes); //contiguous part before the wrap
+    FrameAppend(&(buffSPI[curSPIDev][curRead]), nBytes);
+    FrameAppend(&(buffSPI[curSPIDev][0]), nDataBytes - nBytes);
+    FrameFlush();
+    buffSPIRead[curSPIDev] = RING_INC(curEOR, size);
+}
+
+/**
+ * @brief Frames the oldest Main HK packet in buffHK, or the diagnostic packet once the HK packets are out
+ */
+static void FrameHKPacket()
+{
+    if (buffHKRead == buffHKWrite)
+    {
+        FrameAppend((uint8*)&buffDiag, sizeof(DiagnosticPeriodic));
+        FrameFlush();
+        diagReady = FALSE;
+        return;
+    }
+    FrameAppend((uint8*)&(buffHK[buffHKRead]), sizeof(HousekeepingPeriodic));
+    FrameFlush();
+    buffHKRead = WRAPINC(buffHKRead, HK_BUFFER_PACKETS);
+}
+
+/**
+ * @brief Checks if a source has a packet queued for the frames
+ */
+static uint8 FrameSourcePending(uint8 src)
+{
+    switch (src)
+    {
+        case FRAME_SRC_EVENT:
+            return (packetEvHead != packetEvTail);
+        case FRAME_SRC_BP:
+            return (packetFIFOHead != packetFIFOTail);
+        case FRAME_SRC_HK:
+            return ((buffHKRead != buffHKWrite) || (TRUE == diagReady));
+        default:
+            return FALSE;
+    }
+}
+
+/**
+ * @brief Picks the source to frame a packet from, deficit round robin in frames with a bound on the wait
+ * @details A source visited by the round gets frameSchedQuantum frames of credit and sends packets while
+ * its credit is above 0, a packet can overdraw it. An empty source loses its credit. A source that has waited
+ * frameSchedMaxWait frames while others sent goes next regardless, 0 turns the bound off.
+ * @return uint8 source to frame from, FRAME_SOURCES if nothing is queued
+ */
+static uint8 FrameSchedule()
+{
+    uint8 pending = 0;
+    uint8 src;
+    for (src = 0; src < FRAME_SOURCES; src++)
+    {
+        if (FrameSourcePending(src))
+        {
+            pending |= (1u << src);
+        }
+        else
+        {
+            frameSchedDeficit[src] = 0;
+            frameSchedWait[src] = 0;
+        }
+    }
+    if (0 == pending) return FRAME_SOURCES;
+    frameSchedBound = FALSE;
+    if (0 != frameSchedMaxWait)
+    {
+        uint8 oldest = FRAME_SOURCES;
+        for (src = 0; src < FRAME_SOURCES; src++)
+        {
+            if ((0 != (pending & (1u << src))) && (frameSchedMaxWait <= frameSchedWait[src]) && ((FRAME_SOURCES == oldest) || (frameSchedWait[src] > frameSchedWait[oldest])))
+            {
+                oldest = src;
+            }
+        }
+        if (FRAME_SOURCES != oldest)
+        {
+            frameSchedBound = TRUE;
+            return oldest;
+        }
+    }
+    while ((0 == (pending & (1u << frameSchedCur))) || (0 >= frameSchedDeficit[frameSchedCur]))
+    {
+        if (0 == (pending & (1u << frameSchedCur)))
+        {
+            frameSchedDeficit[frameSchedCur] = 0;
+        }
+        frameSchedCur = WRAPINC(frameSchedCur, FRAME_SOURCES);
+        frameSchedDeficit[frameSchedCur] += MAX(frameSchedQuantum[frameSchedCur], 1);
+    }
+    return frameSchedCur;
+}
+
+/**
+ * @brief Charges the frames a packet from src took, to its credit and to the wait of the sources left queued
+ */
+static void FrameScheduleDone(uint8 src, FmBufferIndex nFrames)
+{
+    if (!frameSchedBound)
+    {
+        frameSchedDeficit[src] -= nFrames;
+    }
+    frameSchedWait[src] = 0;
+    for (uint8 i = 0; i < FRAME_SOURCES; i++)
+    {
+        if ((i != src) && FrameSourcePending(i))
+        {
+            frameSchedWait[i] += nFrames;
+            if (frameSchedWait[i] > frameSchedWaitPeak[i])
+            {
+                frameSchedWaitPeak[i] = frameSchedWait[i];
+            }
+        }
+    }
+}
+
+#if FRAME_USB_GATHER
+/**
+ * @brief Frees the packet at buffFrameUsbRead, and its buffEv bytes for an Event packet
+ */
+static void FrameUsbDone()
+{
+    FrameUsbDesc * desc = &(buffFrameUsb[ buffFrameUsbRead ]);
+    if (FRAME_SRC_EVENT == desc->src)
+    {
+        buffEvRead = RING_ADD(desc->header, desc->nBytes, EV_BUFFER_SIZE);
+    }
+    usbDescFrames -= desc->nFrames - usbDescSent;
+    usbDescSent = 0;
+    buffFrameUsbRead = RING_INC(buffFrameUsbRead, FRAME_USB_DESCS);
+}
+
+/**
+ * @brief Drops the oldest packet queued to USB, its frames not sent yet count as dropped
+ */
+static void FrameUsbDrop()
+{
+    cntFramesDroppedUSB += buffFrameUsb[ buffFrameUsbRead ].nFrames - usbDescSent;
+    FrameUsbDone();
+}
+
+/**
+ * @brief Queues the packet CheckFrameBuffer just framed to USB, from its first frame and its seqH, seqM
+ * @details An Event packet that got all its frames is built again from buffEv by USB, which frees its bytes after.
+ * One that lost frames to HR, and the other sources, are copied from buffFrameData as HR sends them. The oldest
+ * packets are dropped when USB holds FRAME_USB_DESCS packets, FRAME_USB_HOLD_FRAMES frames or FRAME_USB_EV_HOLD
+ * bytes of buffEv. With USB not configured the frames are dropped and the Event bytes freed at once.
+ */
+static void FrameUsbQueue(uint8 src, FmBufferIndex frame, uint16 seq2HB, FmBufferIndex nFrames)
+{
+    EvBufferIndex evEnd = RING_ADD(frameEvHeader, frameEvBytes, EV_BUFFER_SIZE); //end of the Event bytes framed
+    if (!usbFrameLive)
+    {
+        cntFramesDroppedUSB += nFrames;
+        buffEvRead = evEnd;
+        return;
+    }
+    if (0 == RING_FREE(buffFrameUsbRead, buffFrameUsbWrite, FRAME_USB_DESCS))
+    {
+        FrameUsbDrop();
+    }
+    FrameUsbDesc * desc = &(buffFrameUsb[ buffFrameUsbWrite ]);
+    desc->src = src;
+    desc->frame = frame;
+    desc->nFrames = nFrames;
+    desc->seq2HB = seq2HB;
+    desc->header = frameEvHeader;
+    desc->nBytes = frameEvBytes;
+    desc->gather = (FRAME_SRC_EVENT == src) && (((frameEvBytes + FRAME_DATA_BYTES - 1) / FRAME_DATA_BYTES) == nFrames);
+    buffFrameUsbWrite = RING_INC(buffFrameUsbWrite, FRAME_USB_DESCS);
+    usbDescFrames += nFrames;
+    while ((buffFrameUsbRead != buffFrameUsbWrite) && ((FRAME_USB_HOLD_FRAMES < usbDescFrames) || (FRAME_USB_EV_HOLD < RING_LEN(buffEvRead, evEnd, EV_BUFFER_SIZE))))
+    {
+        FrameUsbDrop();
+    }
+}
+
+/**
+ * @brief Checks for a frame queued to USB, frees the packets at buffFrameUsbRead with all their frames sent
+ */
+static uint8 FrameUsbPending()
+{
+    while ((buffFrameUsbRead != buffFrameUsbWrite) && (usbDescSent >= buffFrameUsb[ buffFrameUsbRead ].nFrames))
+    {
+        FrameUsbDone(); //an Event packet with every frame dropped by HR
+    }
+    return (buffFrameUsbRead != buffFrameUsbWrite);
+}
+
+/**
+ * @brief Puts the next frame of the packet at buffFrameUsbRead at dst
+ * @details A gathered Event frame gets its seq from the packet and its data from buffEv, at most 2 memcpy split at
+ * the ring wrap, the last one is padded as FrameFlush does. The other frames are copied from buffFrameData.
+ */
+static void FrameUsbNext(uint8 * dst)
+{
+    FrameUsbDesc * desc = &(buffFrameUsb[ buffFrameUsbRead ]);
+    FmBufferIndex frame = WRAP(desc->frame + usbDescSent, FRAME_BUFFER_SIZE);
+    if (desc->gather)
+    {
+        FrameOutput * out = (FrameOutput *)dst;
+        uint16 seq2HB = desc->seq2HB + (((desc->frame & 0xFF) + usbDescSent) >> 8); //seqM carries when seqL wraps
+        out->seqH = seq2HB >> 8;
+        out->seqM = seq2HB & 0xFF;
+        out->seqL = (uint8)(frame & 0xFF);
+        memcpy(out->sync, frameSync, 2);
+        memcpy((out->sync + 2), frameSync, 2);
+        EvBufferIndex offset = usbDescSent * FRAME_DATA_BYTES;
+        EvBufferIndex curRead = RING_ADD(desc->header, offset, EV_BUFFER_SIZE);
+        uint8 nData = MIN(FRAME_DATA_BYTES, desc->nBytes - offset);
+        uint8 nSpan = MIN(EV_BUFFER_SIZE - curRead, nData); //contiguous part before the wrap
+        memcpy(out->data, (buffEv + curRead), nSpan);
+        memcpy((out->data + nSpan), buffEv, nData - nSpan);
+        if (FRAME_DATA_BYTES > nData)
+        {
+            FramePad(out->data, nData);
+        }
+    }
+    else
+    {
+        memcpy(dst, &(buffFrameData[ frame ]), sizeof(FrameOutput));
+    }
+    usbDescSent++;
+    usbDescFrames--;
+    if (usbDescSent >= desc->nFrames)
+    {
+        FrameUsbDone();
+    }
+}
+#else
+/**
+ * @brief Checks for a frame in buffFrameData not sent to USB yet
+ */
+static uint8 FrameUsbPending()
+{
+    return (buffFrameDataWrite != buffFrameDataReadUSB);
+}
+
+/**
+ * @brief Copies the frame at buffFrameDataReadUSB to dst and frees it
+ */
+static void FrameUsbNext(uint8 * dst)
+{
+    memcpy(dst, &(buffFrameData[ buffFrameDataReadUSB ]), sizeof(FrameOutput));
+    buffFrameDataReadUSB = WRAPINC(buffFrameDataReadUSB, FRAME_BUFFER_SIZE);
+}
+#endif
+
+/**
+ * @brief Sends the frames queued to USB (FrameUsbNext) to the CDC IN endpoint as full size bulk packets
+ * @details The frames are a byte stream to USB, each packet is built in buffUsbTx from USBUART_BUFFER_SIZE bytes
+ * of whole frames, so frames can split across packets. A frame that does not fit is built in usbFrameCarry and
+ * freed, the rest of it starts the next packet, so the packers dropping frames never truncate one on the wire.
+ * A full packet that empties the buffer is followed by a zero length packet so the host ends the transfer.
+ */
+static void CheckFrameUSB()
+{
+    if (0u == USBUART_CD_GetConfiguration())
+    {
+        usbFrameOffset = 0; //start on a whole frame when connected again
+#if FRAME_USB_GATHER
+        while (buffFrameUsbRead != buffFrameUsbWrite)
+        {
+            FrameUsbDrop();
+        }
+        usbFrameLive = FALSE;
+#endif
+        return;
+    }
+#if FRAME_USB_GATHER
+    usbFrameLive = TRUE;
+#endif
+    if (!USBUART_CD_CDCIsReady()) return;
+    uint8 nBytes = 0;
+    if (0 != usbFrameOffset) //rest of the frame split at the end of the last packet
+    {
+        nBytes = sizeof(FrameOutput) - usbFrameOffset;
+        memcpy(buffUsbTx, ((uint8*)&usbFrameCarry) + usbFrameOffset, nBytes);
+        usbFrameOffset = 0;
+    }
+    while ((USBUART_BUFFER_SIZE > nBytes) && FrameUsbPending())
+    {
+        uint8 nFree = USBUART_BUFFER_SIZE - nBytes;
+        if (sizeof(FrameOutput) <= nFree)
+        {
+            FrameUsbNext(buffUsbTx + nBytes);
+            nBytes += sizeof(FrameOutput);
+        }
+        else
+        {
+            FrameUsbNext((uint8*)&usbFrameCarry);
+            memcpy((buffUsbTx + nBytes), &usbFrameCarry, nFree);
+            nBytes += nFree;
+            usbFrameOffset = nFree;
+        }
+    }
+    if (0 == nBytes)
+    {
+        if (usbNeedZLP)
+        {
+            USBUART_CD_PutData(NULL, 0);
+            usbNeedZLP = FALSE;
+        }
+        return;
+    }
+    USBUART_CD_PutData(buffUsbTx, nBytes);
+    usbNeedZLP = (USBUART_BUFFER_SIZE == nBytes);
+}
+
+/**
+ * @brief Restarts DMA_HR_Data when its run is done, feeds USB and frames the next packet FrameSchedule picks
+ * @return int8 1 if a packet was framed, 0 nothing queued
+ */
+int8 CheckFrameBuffer()
+{
+	
+    if (TRUE == DMAHRDataActive)
+    {
+        if (0 != (Status_Reg_UART_DMA_Read() & 0x1)) //nrq indicates the whole run finished
+        {
+            if (ACTIVELEN(DMAHRDataStart, buffFrameDataRead, FRAME_BUFFER_SIZE) < DMAHRDataRun) //frames dropped after DMA_HR_Data sent them can have moved read into the run
+            {
+                buffFrameDataRead = WRAP(DMAHRDataStart + DMAHRDataRun, FRAME_BUFFER_SIZE);
+            }
+            DMAHRDataActive = FALSE;
+        }
+    }
+    if ((FALSE == DMAHRDataActive) && (buffFrameDataWrite != buffFrameDataRead))
+    {
+        StartFrameDMA();
+            
+//        if (UART_HR_Data_GetTxBufferSize() <= 0)
+//        if ((UART_HR_Data_GetTxBufferSize() <= 0) && (0 != (UART_HR_Data_ReadTxStatus() & UART_HR_Data_TX_STS_FIFO_EMPTY  ) ))
+//        {
+////            UART_HR_Data_PutArray((uint8*)&(buffFrameData[ buffFrameDataRead ]) , sizeof(FrameOutput));
+//            buffFrameDataRead = WRAPINC(buffFrameDataRead, FRAME_BUFFER_SIZE);
+//            
+//        }
+    }
+    
+    CheckFrameUSB();
+    FmBufferIndex tmpWrite = buffFrameDataWrite;
+#if FRAME_USB_GATHER
+    uint16 tmpSeq2HB = seqFrame2HB;
+#endif
+    uint8 src = FrameSchedule();
+    switch (src)
+    {
+        case FRAME_SRC_EVENT:
+            FrameEventPacket();
+            break;
+        case FRAME_SRC_BP:
+            FrameBackplanePacket();
+            break;
+        case FRAME_SRC_HK:
+            FrameHKPacket();
+            break;
+        default:
+            return 0; //nothing queued
+    }
+    FmBufferIndex nFrames = ACTIVELEN(tmpWrite, buffFrameDataWrite, FRAME_BUFFER_SIZE);
+#if FRAME_USB_GATHER
+    FrameUsbQueue(src, tmpWrite, tmpSeq2HB, nFrames);
+#endif
+    FrameScheduleDone(src, nFrames);
+    
+    return 1;
+}
+
+//CY_ISR(ISRHRTx)
+//{
+//
+//	uint8 tempStatus;// = UART_HR_Data_ReadTxStatus();
+////	uint8 intState = CyEnterCriticalSection();
+////	UART_HR_Data_PutArray(buffSPIWrite, 34);
+////	isr_HR_Disable();
+////	if (UART_HR_Data_GetTxBufferSize() <= 1) for(uint8 x=0;x<34;x++) UART_HR_Data_PutChar(x);
+////	tempStatus = UART_HR_Data_ReadTxStatus();
+////	isr_HR_ClearPending();
+////	isr_HR_Enable();
+//	
+////	if (0) //TODO integrate Baro and SPI to buffframedata
+//	if (UART_HR_Data_GetTxBufferSize() <= 1)
+//	{
+////	if (FALSE !=((UART_HR_Data_TX_STS_FIFO_EMPTY | UART_HR_Data_TX_STS_COMPLETE) & tempStatus))
+////	{
+////		UART_HR_Data_PutArray((uint8 *)(&frameCnt), 3); //little endian, need big endian
+//		
+//		uint8 buffFrame[34];
+//		uint8 ibuffFrame = 0;
+//		
+//		for (int i = 2; i >= 0; i--)
+//		{
+//			buffFrame[ibuffFrame] = *((uint8*)(((uint8*) &frameCnt) + i)); //this converts to big endian 3 byte counter
+//			UART_HR_Data_PutChar(buffFrame[ibuffFrame]);
+//			ibuffFrame++;
+//		}
+//		uint8 nullFrame = FALSE;
+//		EvBufferIndex nDataBytesLeft = FRAME_DATA_BYTES;
+////		memcpy( (buffFrame + ibuffFrame), &(frameCnt), 3);
+////		ibuffFrame += 3;
+//		frameCnt++;
+//		memcpy( (buffFrame + ibuffFrame), frameSync, 2);
+//		ibuffFrame += 2;
+//		memcpy( (buffFrame + ibuffFrame), frameSync, 2);
+//		ibuffFrame += 2;
+////		buffUsbTxDebug[iBuffUsbTxDebug++] = '{';
+////		buffUsbTxDebug[iBuffUsbTxDebug++] = packetFIFOHead;
+////		buffUsbTxDebug[iBuffUsbTxDebug++] = '+';
+////		buffUsbTxDebug[iBuffUsbTxDebug++] = packetFIFOTail;
+////		buffUsbTxDebug[iBuffUsbTxDebug++] = '}';
+////        if (FALSE) //DEBUG let event buffer fill
+//        if (FRAME_DATA_BYTES <= WRAP(EV_BUFFER_SIZE - buffEvRead + buffEvWrite, EV_BUFFER_SIZE)) //Full frame of event data
+//        {
+//            EvBufferIndex nBytes;
+//            EvBufferIndex curRead = buffEvRead;
+//			EvBufferIndex curEOR = WRAP(curRead + (FRAME_DATA_BYTES - 1), EV_BUFFER_SIZE);
+//			
+//			if (curEOR > curRead)
+//			{
+//				nBytes = FRAME_DATA_BYTES;
+//			}
+//			else
+//			{
+//				nBytes = EV_BUFFER_SIZE - curRead;
+//			}
+//			memcpy( (buffFrame + ibuffFrame), buffEv + curRead, nBytes);
+//			ibuffFrame += nBytes;
+//			nDataBytesLeft -= nBytes;
+////				curRead += (nBytes - 1); //avoiding overflow with - 1 , will add later
+//
+//			if (nDataBytesLeft > 0) //more data to fill frame
+//			{
+//                memcpy( (buffFrame + ibuffFrame), buffEv, nDataBytesLeft);
+//			    ibuffFrame += nDataBytesLeft;
+//			    nDataBytesLeft = 0;
+//			}
+//			curRead = WRAPINC(curEOR, EV_BUFFER_SIZE);
+//            //TODO MUTEX or volatile
+//            buffEvRead = curRead;
+//        }
+//		else if (packetFIFOHead == packetFIFOTail)
+//		{
+//			nullFrame = TRUE;
+//		}
+//		else
+//		{
+//			uint8 curSPIDev = packetFIFO[packetFIFOHead].index;
+//			SPIBufferIndex nBytes;
+//			SPIBufferIndex curEOR= packetFIFO[packetFIFOHead].EOR;
+//			SPIBufferIndex curRead = buffSPIRead[curSPIDev];
+////			buffUsbTxDebug[iBuffUsbTxDebug++] = '|';
+////			buffUsbTxDebug[iBuffUsbTxDebug++] = curSPIDev;
+////			buffUsbTxDebug[iBuffUsbTxDebug++] = '[';
+////			buffUsbTxDebug[iBuffUsbTxDebug++] = curRead;
+////			buffUsbTxDebug[iBuffUsbTxDebug++] = '-';
+////			buffUsbTxDebug[iBuffUsbTxDebug++] = curEOR;
+////			buffUsbTxDebug[iBuffUsbTxDebug++] = ']';
+//			while((packetFIFOHead != packetFIFOTail) && (nDataBytesLeft > 0))
+//			{
+//				if (curEOR >= curRead)
+//				{
+//					nBytes = MIN(((curEOR - curRead) + 1), nDataBytesLeft);
+//				}
+//				else
+//				{
+//					nBytes = MIN(SPI_BUFFER_SIZE - curRead, nDataBytesLeft);
+//				}
+//				memcpy( (buffFrame + ibuffFrame), buffSPI[curSPIDev] + curRead, nBytes);
+//				ibuffFrame += nBytes;
+//				nDataBytesLeft -= nBytes;
+////				curRead += (nBytes); //avoiding overflow with - 1 , will add later
+//				curRead += (nBytes - 1); //avoiding overflow with - 1 , will add later
+////				if ((curRead - 1)== curEOR)
+//				if ((curRead)== curEOR)
+//				{
+//                    curRead = WRAPINC(curRead, SPI_BUFFER_SIZE); //last increment, handling the wrap
+//					buffSPIRead[curSPIDev]= curRead % SPI_BUFFER_SIZE;
+//					packetFIFOHead = WRAPINC(packetFIFOHead, PACKET_FIFO_SIZE);
+//					if (packetFIFOHead != packetFIFOTail) 
+//					{
+//						curSPIDev = packetFIFO[packetFIFOHead].index;
+//						curEOR = packetFIFO[packetFIFOHead].EOR;
+//						curRead = buffSPIRead[curSPIDev];
+//					}
+//				}
+////				else if (curRead >= (SPI_BUFFER_SIZE))
+//				else if (curRead >= (SPI_BUFFER_SIZE - 1))
+//				{
+//					curRead = buffSPIRead[curSPIDev] = 0;
+//				}
+//				else
+//				{
+//                    curRead = WRAPINC(curRead, SPI_BUFFER_SIZE); //last increment, handling the wrap
+//					buffSPIRead[curSPIDev] = curRead;
+//				}
+//			}
+//		}
+//		while (nDataBytesLeft > 0)
+//		{
+//			buffFrame[ibuffFrame] = NULL_HEAD;
+////			UART_HR_Data_PutChar(NULL_HEAD);
+//			ibuffFrame++;
+//			nDataBytesLeft--;
+//			if (nDataBytesLeft > 1)
+//			{
+//				memcpy( &(buffFrame[ibuffFrame]), frame00FF, 2);
+//				ibuffFrame += 2;
+//				nDataBytesLeft -= 2;
+//			}
+//			else //TODO this is an alignment error
+//			{
+//				if (1 == nDataBytesLeft)
+//				{
+//					buffFrame[ibuffFrame] = NULL_HEAD;
+//					ibuffFrame++;
+//					nDataBytesLeft--;
+//				}
+//                cntError++;
+//			}
+//		}
+//		UART_HR_Data_PutArray((uint8 *)(buffFrame + 3), 31); //already sent the 3 byte counter, send rest of frame
+//		if (TRUE != nullFrame)
+//		{
+//			memcpy((buffUsbTx + iBuffUsbTx), buffFrame, 34);
+//			iBuffUsbTx += 34;
+//		}
+//	}
+//	tempStatus = UART_HR_Data_ReadTxStatus();
+//	if ((0u != USBUART_CD_GetConfiguration()) )//&& (iBuffUsbTx > 0))
+//		{
+// 
+//			/* Wait until component is ready to send data to host. */
+//			if (USBUART_CD_CDCIsReady()) // && ((iBuffUsbTx > 0) || (iBuffUsbTxDebug > 0)))
+//			{
+//				if (iBuffUsbTx > 0)
+//				{
+//					USBUART_CD_PutData(buffUsbTx, iBuffUsbTx);
+//					iBuffUsbTx = 0; //TODO handle missed writes
+//				}
+//				if (iBuffUsbTxDebug > 0)
+//				{
+//					while (0 == USBUART_CD_CDCIsReady());
+//					USBUART_CD_PutData(buffUsbTxDebug, iBuffUsbTxDebug);
+//					iBuffUsbTxDebug = 0; //TODO handle missed writes
+//				}
+//			}
+//		}
+//		else
+//		{
+//			iBuffUsbTx = 0; //TODO handle missed writes
+//			iBuffUsbTxDebug = 0; //TODO handle missed writes
+//		}
+//
+////	CyExitCriticalSection(intState);
+//}
+
+/* [] END OF FILE */
@@ -0,0 +1,1005 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Housekeeping for the Main PSOC: I2C transaction queue, barometer capture,
+ * RTC synchronization and the periodic and low rate housekeeping packets.
+ *
+ * ========================================
+*/
+
+#include "daq.h"
+
+HousekeepingPeriodic buffHK[HK_BUFFER_PACKETS];
+uint8 buffHKRead = 0;
+uint8 buffHKWrite = 0;
+
+LowRateHousekeeping lowRateHK;
+
+// Register pointers for the I2C chips
+const uint8 INA226_Config_Reg = 0x00;
+const uint8 INA226_ShuntV_Reg = 0x01;
+const uint8 INA226_BusV_Reg = 0x02;
+const uint8 INA226_Power_Reg = 0x03;
+const uint8 INA226_Current_Reg = 0x04;
+const uint8 INA226_Calib_Reg = 0x05;
+const uint8 INA226_Mask_Reg = 0x06;
+const uint8 INA226_Alert_Reg = 0x07;
+const uint8 TMP100_Temp_Reg = 0x00;
+const uint8 Barometer_Pres_Reg = 0xF7;
+const uint8 Barometer_COE_PR11 = 0xA0;
+const uint8 Barometer_COE_PTAT21 = 0xB1;
+
+
+//#define I2C_MAX_RETRIES (1u)
+I2CTrans buffI2C[I2C_BUFFER_SIZE];
+uint8 buffI2CRead, buffI2CWrite;
+uint8 numI2CRetry = 0;
+uint8 I2CMaxRetries = 1;
+
+HousekeepingTrackI2C mainHKI2C[MAIN_HK_I2C_BUFFER_SIZE]= {
+{I2C_ADDRESS_BAROMETER, 0xF7, 6, NULL, 0, 0},//Barometer_Pres_Reg = 0xF7
+{I2C_ADDRESS_TMP100, NO_WRITE_REG_ADDRESS, 2, NULL, 0, 0},//TMP100 defaults to read temp reg
+{I2C_ADDRESS_INA226_3V_DIG, 0x02, 2, NULL, 0, 0},//INA226_BusV_Reg = 0x02
+{I2C_ADDRESS_INA226_3V_DIG, 0x01, 2, NULL, 0, 0},//INA226_ShuntV_Reg = 0x01
+{I2C_ADDRESS_INA226_3V_ANA, 0x02, 2, NULL, 0, 0},//INA226_BusV_Reg = 0x02
+{I2C_ADDRESS_INA226_3V_ANA, 0x01, 2, NULL, 0, 0},//INA226_ShuntV_Reg = 0x01
+{I2C_ADDRESS_INA226_5V_DIG, 0x02, 2, NULL, 0, 0},//INA226_BusV_Reg = 0x02
+{I2C_ADDRESS_INA226_5V_DIG, 0x01, 2, NULL, 0, 0},//INA226_ShuntV_Reg = 0x01
+{I2C_ADDRESS_INA226_5V_ANA, 0x02, 2, NULL, 0, 0},//INA226_BusV_Reg = 0x02
+{I2C_ADDRESS_INA226_5V_ANA, 0x01, 2, NULL, 0, 0},//INA226_ShuntV_Reg = 0x01
+{I2C_ADDRESS_INA226_15V_DIG, 0x02, 2, NULL, 0, 0},//INA226_BusV_Reg = 0x02
+{I2C_ADDRESS_INA226_TRACKER_SUPPLY, 0x02, 2, NULL, 0, 0},//INA226_BusV_Reg = 0x02
+{I2C_ADDRESS_INA226_TRACKER_SUPPLY, 0x01, 2, NULL, 0, 0},//INA226_ShuntV_Reg = 0x01
+{I2C_ADDRESS_INA226_TRACKER_BIAS, 0x02, 2, NULL, 0, 0}};//INA226_BusV_Reg = 0x02
+
+uint8 mainHKI2CRead = 0;
+
+uint8 baroOnboardOTP[20];//storage for the OTP baro coefficients
+
+RTC_Main_TIME_DATE mainTimeDate;// Structure for a local copy of RTC values, not updated by RTC
+RTC_Main_TIME_DATE* mainTimeDateSysPtr;// Structure for a local copy of RTC values, not updated by RTC
+
+uint8 rtcStatus; 
+
+uint8 dataRTCI2C[DATA_RTS_I2C_BYTES] = {
+0x00, //Register addresss for seconds, start of trans
+0x80, //Sec Register to init , MSb write starts clock
+0x00, //Min Register
+0x00, //Hour Register
+0x09, //Day Register with Batt enable and Day 1
+((MINOR_VERSION + 1) & 0x17), //Date Register, use version to produce a default value
+(MAJOR_VERSION & 0x17), //Month Register, use version to produce a default value
+0x00}; //Year Register
+
+
+uint8 curRTSI2CTrans = I2C_BUFFER_SIZE;
+
+uint16 buffBaroCap[NUM_BARO *2][NUM_BARO_CAPTURES];
+uint8 buffBaroCapRead[NUM_BARO *2];
+volatile uint8 buffBaroCapWrite[NUM_BARO *2];
+//DEBUG with num caps per isr 
+//uint16 buffBaroCapNum[NUM_BARO *2][NUM_BARO_CAPTURES]; 
+//uint8 buffBaroCapNumWrite;
+
+volatile uint8 cntSecs = 0; //count 1 sec interrupts for housekeeping packet rates
+uint8 hkSecs = 5; //# of secs per housekeeping packet
+volatile uint8 hkReq = FALSE; //state to request packet 
+uint8 hkCollecting = FALSE; //state to request packet 
+volatile uint8 lowRateReq = FALSE; //state to request low rate science data packet 
+
+
+//const BaroCoEff baroCE[NUM_BARO] = {{.U0 = 1.0, .Y1 = 1.0, .Y2 = 1.0, .Y3 = 1.0, .C1 = 1.0, .C2 = 1.0, .C3 = 1.0, .D1 = 1.0, .D2 = 1.0, .T1 = 1.0, .T2 = 1.0, .T3 = 1.0, .T4 = 1.0, .T5 = 1.0 }};
+//const BaroCoEff baroCE[NUM_BARO] = {{.U0 = 5.875516, .Y1 = -3947.926, .Y2 = -10090.9, .Y3 = 0.0, .C1 = 95.4503, .C2 = 2.982818, .C3 = -135.3036, .D1 = 0.042247, .D2 = 0.0, .T1 = 27.91302, .T2 = 0.873949, .T3 = 21.00155, .T4 = 36.63574, .T5 = 0.0 }};
+//double curBaroTemp[NUM_BARO];
+//double curBaroPres[NUM_BARO];
+uint32 curBaroTempCnt[NUM_BARO];
+uint32 curBaroPresCnt[NUM_BARO];
+uint32 baroReadReady = 0u;
+
+int16 dieTemp;//temperature of the PSOC from system call
+
+uint8 outputBusy = FALSE; //state for Pin_Busy, True when fram fifo queue is above a threshold
+uint8 outputBusyHighThres = 80; //high threhold of fifo percentage
+uint8 outputBusyLowThres = 70; //low threhold of fifo percentage
+
+
+//
+//double BaroTempCalc ( double U, const BaroCoEff * bce )
+//{
+//	return (((bce->Y1) * U) + ((bce->Y2) * pow(U, 2))  + ((bce->Y3) * pow(U, 3)));
+//}
+//
+//double BaroPresCalc ( double Tao, double U, const BaroCoEff * bce )
+//{
+//	double Usq = pow( U, 2);
+//	double C = ((bce->C1) + ((bce->C2) * U) + ((bce->C3) * Usq)); 
+//	double D = ((bce->D1) + ((bce->D2) * U)); 
+//	double T0 = ((bce->T1) + ((bce->T2) * U) + ((bce->T3) * Usq) + ((bce->T4) * (U * Usq)) + ((bce->T5) * (Usq * Usq))); 
+//	double ratio = (1 - (pow(T0, 2) / pow(Tao, 2)));
+//	return ((C * ratio) * (1 - (D * ratio)));
+//}
+
+uint8 BCD2Dec( uint8 bcd )
+{
+    return bcd - (6 * (bcd >> 4));
+}
+uint8 Dec2BCD( uint8 dec )
+{
+    uint16 num16 = dec;
+    uint16 num8 = (uint8)((num16 * 103) >> 10);
+    return dec + (6 * num8);
+}
+
+int InitLRScienceData()
+{
+    lowRateHK.dle = DLE;
+    lowRateHK.scienceDataID = SDATA_ID;
+    lowRateHK.dataLength = sizeof(lowRateHK) - 4;//adapt to changing sizes, 4 formatting bytes not included 
+    lowRateHK.mainMajorV = MAJOR_VERSION;//version to start, try to avoid confusion with LR events
+    lowRateHK.mainMinorV = MINOR_VERSION;//version to start, try to avoid confusion with LR events
+    lowRateHK.etx = ETX;
+    return 1;
+}
+
+int CheckLRScienceData()
+{
+
+    if (lowRateReq)
+    {
+    
+        //TODO event option
+        if(0 == UART_LR_Data_GetTxBufferSize()) //Requests only come once every 30 Sec so if the buffer is not empty
+        {
+            uint8 curMainHK = WRAPDEC(buffHKWrite, HK_BUFFER_PACKETS); //the packet prior to the current write is most likely complete or blank        
+            memcpy(lowRateHK.mainHK, buffHK[curMainHK].packedTimeDate, sizeof(lowRateHK.mainHK));//copy latest Main HK minus headers
+            //TODO event HK needs to be copaaesied in CheckeEventPackets 
+            UART_LR_Data_PutArray((uint8 *) &lowRateHK, sizeof(lowRateHK));
+            lowRateReq = FALSE; //might need to make a critical section but the buffer in transmision should avoid duplicate sends.
+            return 1;
+        }
+        else
+        {
+            lowRateReq = FALSE; //might need to make a critical section but the buffer in transmision should avoid duplicate sends.
+            cntError++;
+            return -EBUSY;
+        }
+    }
+    return 0;
+}
+
+uint8 CheckI2C()
+{
+	if( buffI2CRead != buffI2CWrite)  //Check if any transactions
+	{
+        uint8 status;
+
+        status = I2C_RTC_MasterStatus();
+        if( 0 == (status & I2C_RTC_MSTAT_XFER_INP )) //Check if busy
+        {
+
+            uint8 errors;
+            errors = (status & I2C_RTC_MSTAT_ERR_MASK);
+
+            //TODO handle completion and errors
+            if( errors != 0)
+            {
+                buffI2C[buffI2CRead].error = errors;
+                buffI2CRead = RING_INC(buffI2CRead, I2C_BUFFER_SIZE);
+                numI2CRetry = 0;
+                cntError++;
+            }
+            else if ( 0 != (status & I2C_RTC_MSTAT_RD_CMPLT ))
+            {
+                if(I2C_READ ==  buffI2C[buffI2CRead].type)
+                {
+                    buffI2C[buffI2CRead].error = 0;  
+                }
+                else 
+                {
+                    buffI2C[buffI2CRead].error = I2C_RTC_MSTAT_ERR_MASK; //TODO new Error for thei mismatch
+                    cntError++;
+                }
+                buffI2CRead = RING_INC(buffI2CRead, I2C_BUFFER_SIZE);
+                numI2CRetry = 0;
+            }
+            else if ( 0 != (status & I2C_RTC_MSTAT_WR_CMPLT ))
+            {
+                if(I2C_WRITE ==  buffI2C[buffI2CRead].type)
+                {
+                    buffI2C[buffI2CRead].error = 0;  
+                }
+                else 
+                {
+                    buffI2C[buffI2CRead].error = I2C_RTC_MSTAT_ERR_MASK; //TODO new Error for thei mismatch
+                    cntError++;
+                }
+                buffI2CRead = RING_INC(buffI2CRead, I2C_BUFFER_SIZE);
+                numI2CRetry = 0;
+            }
+            else //execute new transacttion
+            {
+                if(I2C_WRITE ==  buffI2C[buffI2CRead].type)
+                {
+                    errors = I2C_RTC_MasterWriteBuf(buffI2C[buffI2CRead].slaveAddress, buffI2C[buffI2CRead].data, buffI2C[buffI2CRead].cnt, buffI2C[buffI2CRead].mode);
+                    if (0 != errors)
+                    {
+                        cntError++;
+                        //TODO handle individual errors
+                        numI2CRetry++;
+                    }
+                }
+                else if(I2C_READ ==  buffI2C[buffI2CRead].type)
+                {
+                    errors = I2C_RTC_MasterReadBuf(buffI2C[buffI2CRead].slaveAddress, buffI2C[buffI2CRead].data, buffI2C[buffI2CRead].cnt, buffI2C[buffI2CRead].mode);
+                    if (0 != errors)
+                    {
+                        cntError++;
+                        //TODO handle individual errors
+                        numI2CRetry++;
+                    }
+                }
+//                if (I2C_MAX_RETRIES <= numI2CRetry)
+                if (I2CMaxRetries <= numI2CRetry)
+                {
+                    buffI2C[buffI2CRead].error = errors;
+                    buffI2CRead = RING_INC(buffI2CRead, I2C_BUFFER_SIZE);
+                    numI2CRetry = 0;
+                }
+            }
+        }
+        I2C_RTC_MasterClearStatus();
+    }
+    
+    return 0;
+}
+
+const uint8 ForcedSampleBaroI2CBytes[2] = {0xF4, 0xFD}; //F4 is CTRL_MEAS register address. In FD 01 lsb is forcedmode, rest 1s 64 avg for both temp and pressure
+
+int8 ForcedSampleBaroI2C()
+{
+    if(I2C_BUFFER_SIZE > (2 + RING_LEN(buffI2CRead, buffI2CWrite, I2C_BUFFER_SIZE)))
+    {
+        buffI2C[buffI2CWrite].type = I2C_WRITE;//need to write to reg to force sample
+        buffI2C[buffI2CWrite].slaveAddress = I2C_ADDRESS_BAROMETER;
+        buffI2C[buffI2CWrite].cnt = 2;
+        buffI2C[buffI2CWrite].data = (uint8 *)ForcedSampleBaroI2CBytes;//register then value to force samp, I2C_RTC_MasterWriteBuf only reads it
+        buffI2C[buffI2CWrite].mode = I2C_RTC_MODE_COMPLETE_XFER;
+        buffI2CWrite = RING_INC(buffI2CWrite, I2C_BUFFER_SIZE);
+                    
+        return 1;
+    }
+    else
+    {
+        return -EBUSY;
+    }
+}
+
+int8 InitBaroI2COTP()//get OTP coeffienct to adjust the raw outputs on the GSE 
+{
+     if(I2C_BUFFER_SIZE > (5 + RING_LEN(buffI2CRead, buffI2CWrite, I2C_BUFFER_SIZE)))
+    {
+        
+        
+        buffI2C[buffI2CWrite].type = I2C_WRITE;//need to write to reg 
+        buffI2C[buffI2CWrite].slaveAddress = I2C_ADDRESS_BAROMETER;
+        buffI2C[buffI2CWrite].cnt = 1;//reg byte address
+        buffI2C[buffI2CWrite].data = (uint8 *)&Barometer_COE_PR11;//data points to the register number
+//        buffI2C[buffI2CWrite].mode = I2C_RTC_MODE_NO_STOP;
+        buffI2C[buffI2CWrite].mode = I2C_RTC_MODE_COMPLETE_XFER;
+        buffI2CWrite = RING_INC(buffI2CWrite, I2C_BUFFER_SIZE);
+        
+        buffI2C[buffI2CWrite].type = I2C_READ;//need to read the OTP
+        buffI2C[buffI2CWrite].slaveAddress = I2C_ADDRESS_BAROMETER;
+        buffI2C[buffI2CWrite].cnt = 16;//16 is first set of OTP
+        buffI2C[buffI2CWrite].data = baroOnboardOTP;//data pointer to start of OTP storage
+        buffI2C[buffI2CWrite].mode = I2C_RTC_MODE_COMPLETE_XFER;
+        buffI2CWrite = RING_INC(buffI2CWrite, I2C_BUFFER_SIZE);
+        
+        buffI2C[buffI2CWrite].type = I2C_WRITE;//need to write to reg
+        buffI2C[buffI2CWrite].slaveAddress = I2C_ADDRESS_BAROMETER;
+        buffI2C[buffI2CWrite].cnt = 1;//reg byte address
+        buffI2C[buffI2CWrite].data = (uint8 *)&Barometer_COE_PTAT21;//data points to the register number
+//        buffI2C[buffI2CWrite].mode = I2C_RTC_MODE_NO_STOP;
+        buffI2C[buffI2CWrite].mode = I2C_RTC_MODE_COMPLETE_XFER;
+        buffI2CWrite = RING_INC(buffI2CWrite, I2C_BUFFER_SIZE);
+        
+        buffI2C[buffI2CWrite].type = I2C_READ;//need to read the OTP
+        buffI2C[buffI2CWrite].slaveAddress = I2C_ADDRESS_BAROMETER;
+        buffI2C[buffI2CWrite].cnt = 4;//4  more OTP
+        buffI2C[buffI2CWrite].data = (baroOnboardOTP + 16);//data pointer to rest of OTP storage
+        buffI2C[buffI2CWrite].mode = I2C_RTC_MODE_COMPLETE_XFER;
+        buffI2CWrite = RING_INC(buffI2CWrite, I2C_BUFFER_SIZE);
+        
+        return 1;
+    }
+    else
+    {
+        return -EBUSY;
+    }
+}
+
+
+uint8 InitRTC()
+{
+//    mainTimeDate = RTC_Main_ReadTime(); //TODO dont write to the read loactiion, create temp structure
+//    RTC_Main_TIME_DATE mainTimeDateTemp; //create temp structure
+    mainTimeDate.Sec = 0;
+    mainTimeDate.Min = 0;
+    mainTimeDate.Hour = 0;
+    mainTimeDate.DayOfWeek = 1; //0 is not valid and WriteTime doesn't modify this
+    mainTimeDate.DayOfMonth = MAJOR_VERSION % 30;
+    mainTimeDate.DayOfYear = MAJOR_VERSION % 30;
+    mainTimeDate.Month = 1;
+    mainTimeDate.Year = MINOR_VERSION;
+    RTC_Main_WriteTime(&mainTimeDate);
+    RTC_Main_Start();
+    return mainTimeDate.Year;
+}
+uint8 InitHKBuffer()
+{
+    uint8 initHK = 0;
+    while (HK_BUFFER_PACKETS > initHK)
+    {
+        buffHK[initHK].header[0] = HK_HEAD;
+        memcpy(buffHK[initHK].header + 1, frame00FF, 2);
+//        buffHK[initHK].version[0] = MAJOR_VERSION;
+//        buffHK[initHK].version[1] = MINOR_VERSION;
+        buffHK[initHK].EOR[0] = EOR_HEAD;
+        memcpy(buffHK[initHK].EOR + 1, frame00FF, 2);
+//        memset(buffHK[initHK].padding, 0, HK_PAD_SIZE);
+        initHK++;
+        
+    }
+    return initHK;
+}
+
+uint8 CheckHKBuffer()
+{
+    if (TRUE == hkCollecting) //see if collecting is done
+    {
+        
+        uint8 continueCheck = TRUE;
+        do
+        {
+            if( I2C_BUFFER_SIZE == mainHKI2C[mainHKI2CRead].readTrans ) //if set to this there re no more transactions
+            {
+                mainHKI2CRead = MAIN_HK_I2C_BUFFER_SIZE;
+                continueCheck = FALSE;
+            }
+            else if( ISELEMENTDONE(mainHKI2C[mainHKI2CRead].readTrans, buffI2CRead, buffI2CWrite) )// checck if transaction done
+            {
+                
+            
+                if(buffI2C[mainHKI2C[mainHKI2CRead].readTrans].error )
+                {
+                    memset(mainHKI2C[mainHKI2CRead].data, 0, mainHKI2C[mainHKI2CRead].cnt);//0 values since errors
+                    
+                    buffHK[buffHKWrite].missingValuesThisPacket++;
+                }
+                else if(I2C_BUFFER_SIZE != mainHKI2C[mainHKI2CRead].writeTrans)
+                {
+                    if(buffI2C[mainHKI2C[mainHKI2CRead].writeTrans].error )
+                    {
+                        memset(mainHKI2C[mainHKI2CRead].data, 0, mainHKI2C[mainHKI2CRead].cnt);//0 values since errors
+                        
+                        buffHK[buffHKWrite].missingValuesThisPacket++;
+                    }
+                }
+                mainHKI2CRead++;
+                
+            }
+            else 
+            {
+                continueCheck = FALSE;// wait for I2c
+            }
+            if (MAIN_HK_I2C_BUFFER_SIZE <= mainHKI2CRead)
+            {
+                memcpy(buffHK[buffHKWrite].commandLast, buffCmd[lastCmdSource][RING_DEC(writeBuffCmd[lastCmdSource], CMD_BUFFER_SIZE)], 2); //copy the last command recieved 
+                uint32 temp32 = cntCmd;
+                buffHK[buffHKWrite].commandCount[1] = temp32 & 0xFF; //LSB of command count
+                temp32 >>= 8;
+                buffHK[buffHKWrite].commandCount[0] = temp32 & 0xFF; //MSB of command count
+                buffHK[buffHKWrite].commandErrors = cntCmdError;
+                buffHK[buffHKWrite].generalErrors = cntError;
+                temp32 = ACTIVELEN(buffFrameDataRead, buffFrameDataWrite, FRAME_BUFFER_SIZE) * 100;
+                temp32 /= FRAME_BUFFER_SIZE;
+                buffHK[buffHKWrite].fifoPercentFull = temp32 & 0xFF;
+                if ((TRUE == outputBusy) && (outputBusyLowThres >= buffHK[buffHKWrite].fifoPercentFull))
+                {
+                    outputBusy = FALSE;
+                    Pin_Busy_Write(outputBusy);// no longer signal busy
+                    Pin_LED2_Write(outputBusy);
+                }
+                else if ((FALSE == outputBusy) && (outputBusyHighThres <= buffHK[buffHKWrite].fifoPercentFull))
+                {
+                    outputBusy = TRUE;
+                    Pin_Busy_Write(outputBusy);//signal busy
+                    Pin_LED2_Write(outputBusy);
+                }
+                temp32 = cntFramesDropped;
+                buffHK[buffHKWrite].framesDroppedRS232[1] = temp32 & 0xFF; //LSB of Dropped RS232 packets
+                temp32 >>= 8;
+                buffHK[buffHKWrite].framesDroppedRS232[0] = temp32 & 0xFF; //MSB of Dropped RS232 packets
+                temp32 = cntFramesDroppedUSB;
+                buffHK[buffHKWrite].framesDroppedUSB[1] = temp32 & 0xFF; //LSB of Dropped USB packets
+                temp32 >>= 8;
+                buffHK[buffHKWrite].framesDroppedUSB[0] = temp32 & 0xFF; //MSB of Dropped USB packets
+                if  (CYRET_SUCCESS == DieTemp_Main_Query(&dieTemp))
+                {
+                    int16 temp16 = dieTemp; //signed 16 bit from -40 to 140
+                    buffHK[buffHKWrite].coreDieTemp[1] = temp16 & 0xFF; //LSB of core temp
+                    temp16 >>= 8;
+                    buffHK[buffHKWrite].coreDieTemp[0] = temp16 & 0xFF; //MSB of core temp
+                }
+                else
+                {
+                    buffHK[buffHKWrite].missingValuesThisPacket++;
+                    buffHK[buffHKWrite].coreDieTemp[0] = 0x80; //MSB of core temp, Max negative number is out-of-range error indicator 
+                    buffHK[buffHKWrite].coreDieTemp[1] = 0x00; //LSB of core temp
+                    cntError++;// TODO could check specific error
+                }
+                buffHK[buffHKWrite].generalErrors = cntError;
+                buffHKWrite = WRAPINC( buffHKWrite , HK_BUFFER_PACKETS );
+                FillDiagPacket(); //goes out after this HK packet
+                hkCollecting = FALSE;
+                ForcedSampleBaroI2C(); //Force sample next Baro
+                Pin_LED1_Write(0);
+                return 1;
+            }
+        }while(continueCheck);
+        
+    }
+    else if ((TRUE == hkReq)) //see if req is made by ISRCheckBaro
+    {
+        Pin_LED1_Write(1);
+        hkCollecting = TRUE;
+        hkReq = FALSE; //single byte store, ISRBaroCap only sets it
+        //start specific data collection
+//        uint32 temp32 = curBaroTempCnt[0];
+////        int8 i=2; //24bit for Counter1 style packet DEBUG
+//        int8 i=3; //32bit 
+//        buffHK[buffHKWrite].baroTemp1[i] = temp32 & 0xFF; // to make this endian independent and output as big endian, fill the LSB first
+//        while (0 <= --i) //Fill the Higher order bytes
+//        {
+//            temp32 >>= 8;
+//            buffHK[buffHKWrite].baroTemp1[i] = temp32 & 0xFF;
+//        }
+//        temp32 = curBaroPresCnt[0];
+//      i=3; //32bit
+////        i=2; //24bit for Counter1 style packet DEBUG
+//        buffHK[buffHKWrite].baroPres1[i] = temp32 & 0xFF; // to make this endian independent and output as big endian, fill the LSB first
+//        while (0 <= --i) //Fill the Higher order bytes
+//        {
+//            temp32 >>= 8;
+//            buffHK[buffHKWrite].baroPres1[i] = temp32 & 0xFF;
+//        }
+//        temp32 = curBaroTempCnt[1];
+//        i=3; //32bit
+////        i=2; //24bit for Counter1 style packet DEBUG
+//        buffHK[buffHKWrite].baroTemp2[i] = temp32 & 0xFF; // to make this endian independent and output as big endian, fill the LSB first
+//        while (0 <= --i) //Fill the Higher order bytes
+//        {
+//            temp32 >>= 8;
+//            buffHK[buffHKWrite].baroTemp2[i] = temp32 & 0xFF;
+//        }
+//        temp32 = curBaroPresCnt[1];
+//        i=3; //32bit
+////        i=2; //24bit for Counter1 style packet DEBUG
+//        buffHK[buffHKWrite].baroPres2[i] = temp32 & 0xFF; // to make this endian independent and output as big endian, fill the LSB first
+//        while (0 <= --i) //Fill the Higher order bytes
+//        {
+//            temp32 >>= 8;
+//            buffHK[buffHKWrite].baroPres2[i] = temp32 & 0xFF;
+//        }
+//        RTC_Main_DisableInt();
+//        mainTimeDateSysPtr = RTC_Main_ReadTime();
+//        memcpy(&mainTimeDate, mainTimeDateSysPtr, sizeof(mainTimeDate));// copy to local struct before update
+//        RTC_Main_EnableInt();
+        
+//        temp32 = (uint32)(mainTimeDate.Year % 2000) << 4;
+//        temp32 |= mainTimeDate.Month;
+//        temp32 <<= 5;//shift left to make room for new bits;
+//        temp32 |= mainTimeDate.DayOfMonth;
+//        temp32 <<= 5;//shift left to make room for new bits;
+//        temp32 |= mainTimeDate.Hour;
+//        temp32 <<= 6;//shift left to make room for new bits;
+//        temp32 |= mainTimeDate.Min;
+//        temp32 <<= 6;//shift left to make room for new bits;
+//        temp32 |= mainTimeDate.Sec;
+//        
+////        temp32 = 60 * ( ( 60 * mainTimeDate.Hour) + mainTimeDate.Min ) + mainTimeDate.Sec; // Convert RTC to secs
+//        i=3; //32bit
+////        i=2; //24bit for Counter1 style packet DEBUG
+//        buffHK[buffHKWrite].packedTimeDate[i] = temp32 & 0xFF; // to make this endian independent and output as big endian, fill the LSB first
+//        while (0 <= --i) //Fill the Higher order bytes
+//        {
+//            temp32 >>= 8;
+//            buffHK[buffHKWrite].packedTimeDate[i] = temp32 & 0xFF;
+//        }
+        
+//        uint8 buffBaroCapNumWriteTemp = buffBaroCapNumWrite; //DEBUG
+//        if (buffBaroCapNumWriteTemp )
+//        {
+//            buffBaroCapNumWriteTemp--;
+//        }
+//        else 
+//        {
+//            buffBaroCapNumWriteTemp = NUM_BARO_CAPTURES - 1;
+//        }
+//        if ((0 != buffBaroCapNum[0][buffBaroCapNumWriteTemp]) && (buffBaroCapNum[0][buffBaroCapNumWriteTemp] == buffBaroCapNum[1][buffBaroCapNumWriteTemp])  && (buffBaroCapNum[2][buffBaroCapNumWriteTemp] == buffBaroCapNum[3][buffBaroCapNumWriteTemp])) buffHK[buffHKWrite].padding[0]=1;//DEBUG
+//        Pin_CE1_Write(buffHK[buffHKWrite].secs[3] % 2); //DEBUG timing on scope
+        
+        //load the data pointer of each
+        mainHKI2C[0].data = buffHK[buffHKWrite].baroPres3;//I2C Address 1110000
+        mainHKI2C[1].data = buffHK[buffHKWrite].boardTemperature;//I2C Address 1001000
+        mainHKI2C[2].data = buffHK[buffHKWrite].digital3VVoltage;//I2C Address 1000100
+        mainHKI2C[3].data = buffHK[buffHKWrite].digital3VAmperage;//I2C Address 1000100
+        mainHKI2C[4].data = buffHK[buffHKWrite].analog3VVoltage;//I2C Address 1000011
+        mainHKI2C[5].data = buffHK[buffHKWrite].analog3VAmperage;//I2C Address 1000011
+        mainHKI2C[6].data = buffHK[buffHKWrite].digital5VVoltage;//I2C Address 1000001
+        mainHKI2C[7].data = buffHK[buffHKWrite].digital5VAmperage;//I2C Address 1000001
+        mainHKI2C[8].data = buffHK[buffHKWrite].analog5VVoltage;//I2C Address 1000101
+        mainHKI2C[9].data = buffHK[buffHKWrite].analog5VAmperage;//I2C Address 1000101
+        mainHKI2C[10].data = buffHK[buffHKWrite].digital15VVoltage;//I2C Address 1000010
+        mainHKI2C[11].data = buffHK[buffHKWrite].trackerVoltage;//I2C Address 1000000
+        mainHKI2C[12].data = buffHK[buffHKWrite].trackerAmperage;//I2C Address 1000000
+        mainHKI2C[13].data = buffHK[buffHKWrite].trackerBiasVoltage;//I2C Address 1000110
+        mainHKI2CRead = 0; //start from begining of i2c tracker
+        uint8 fullI2CTrans = FALSE;
+        for (uint8 curI2C = 0; curI2C < MAIN_HK_I2C_BUFFER_SIZE; curI2C++)//create all i2c transations
+        {
+            if(fullI2CTrans)
+            {
+                mainHKI2C[curI2C].writeTrans = I2C_BUFFER_SIZE; //buffer full so don't attempt this i2c 
+                mainHKI2C[curI2C].readTrans = I2C_BUFFER_SIZE; //buffer full so don't attempt this i2c
+                buffHK[buffHKWrite].missingValuesThisPacket++;
+            }
+            else
+            {
+                if(I2C_BUFFER_SIZE <= (3 + RING_LEN(buffI2CRead, buffI2CWrite, I2C_BUFFER_SIZE)))
+                {
+                    mainHKI2C[curI2C].writeTrans = I2C_BUFFER_SIZE; //buffer full so don't attempt this i2c 
+                    mainHKI2C[curI2C].readTrans = I2C_BUFFER_SIZE; //buffer full so don't attempt this i2c
+                    buffHK[buffHKWrite].missingValuesThisPacket++;
+                    fullI2CTrans = TRUE;
+                }
+                else
+                {
+                    if(NO_WRITE_REG_ADDRESS == mainHKI2C[curI2C].regAddress)
+                    {
+                        mainHKI2C[curI2C].writeTrans = I2C_BUFFER_SIZE; //no need to write reg pointer 
+                        
+                    }
+                    else
+                    {
+                        mainHKI2C[curI2C].writeTrans = buffI2CWrite;//index so can check results
+                        buffI2C[buffI2CWrite].type = I2C_WRITE;//need to write the register pointer
+                        buffI2C[buffI2CWrite].slaveAddress = mainHKI2C[curI2C].slaveAddress;
+                        buffI2C[buffI2CWrite].cnt = 1;// only 1 byte
+                        buffI2C[buffI2CWrite].data = &(mainHKI2C[curI2C].regAddress);//data points to the register number
+//                        if (2 > curI2C) //DEBUG Baro and Temp I2C do not want stops
+//                        {
+//                            buffI2C[buffI2CWrite].mode = I2C_RTC_MODE_NO_STOP;
+//                            
+//                        }
+//                        else 
+//                        {
+                            buffI2C[buffI2CWrite].mode = I2C_RTC_MODE_COMPLETE_XFER;
+//                        }
+                        buffI2CWrite = RING_INC(buffI2CWrite, I2C_BUFFER_SIZE);
+                        
+                    }
+                    mainHKI2C[curI2C].readTrans = buffI2CWrite;//index so can check results
+                    buffI2C[buffI2CWrite].type = I2C_READ;//need to read the values
+                    buffI2C[buffI2CWrite].slaveAddress = mainHKI2C[curI2C].slaveAddress;
+                    buffI2C[buffI2CWrite].cnt = mainHKI2C[curI2C].cnt;//spefic number of bytes to readout
+                    buffI2C[buffI2CWrite].data = mainHKI2C[curI2C].data;//data pointer
+                    buffI2C[buffI2CWrite].mode = I2C_RTC_MODE_COMPLETE_XFER;
+                    
+                    buffI2CWrite = RING_INC(buffI2CWrite, I2C_BUFFER_SIZE);
+                }
+                
+            }
+            
+            
+        }
+        DieTemp_Main_Start();//start the temp conversion and Query the result at that end of HK. TODO could check error returns but handled at Query for now
+        buffHK[buffHKWrite].missingValuesThisPacket = 0;
+       
+    }
+    return 0;
+}
+
+uint8 CheckRTC()
+{
+    if (0 != (rtcStatus & RTS_SET_MAIN_INP))
+    {
+        uint8 curRTSI2CTrans2 = RING_INC(curRTSI2CTrans, I2C_BUFFER_SIZE);
+        if ( (0 != buffI2C[curRTSI2CTrans].error) && ( ISELEMENTDONE(curRTSI2CTrans, buffI2CRead, buffI2CWrite)))
+        {
+            cntError++;
+            //TODO error handling
+//            rtcStatus |= RTS_SET_MAIN; //Retry forever DEBUG
+            rtcStatus ^= RTS_SET_MAIN_INP;
+        }
+        else if (ISELEMENTDONE(curRTSI2CTrans2, buffI2CRead, buffI2CWrite))
+        {
+            if (0 != buffI2C[curRTSI2CTrans2].error)
+            {
+                cntError++;
+                //TODO error handling
+//                rtcStatus |= RTS_SET_MAIN; //Retry forever DEBUG
+                rtcStatus ^= RTS_SET_MAIN_INP;
+            }   
+            else
+            {
+                mainTimeDate.Sec = BCD2Dec(dataRTCI2C[1] & 0x7F);
+                mainTimeDate.Min = BCD2Dec(dataRTCI2C[2] & 0x7F);
+                mainTimeDate.Hour = BCD2Dec(dataRTCI2C[3] & 0x3F);
+//                mainTimeDate.DayOfWeek = (dataRTCI2C[4] & 0x07); //0 is not valid and WriteTime doesn't modify this
+                mainTimeDate.DayOfMonth = BCD2Dec(dataRTCI2C[5] & 0x3F);
+                mainTimeDate.Month = BCD2Dec(dataRTCI2C[6] & 0x1F);
+                mainTimeDate.Year = BCD2Dec(dataRTCI2C[7]) + 2000;
+                RTC_Main_WriteTime(&mainTimeDate);
+//                RTC_Main_Init();//Sets RTC variables DEBUG
+                rtcStatus ^= RTS_SET_MAIN_INP;
+            }
+        }
+    }
+    else if (0 != (rtcStatus & RTS_SET_I2C_INP))
+    {
+        if ( ISELEMENTDONE(curRTSI2CTrans, buffI2CRead, buffI2CWrite))
+        {
+            if (0 != buffI2C[curRTSI2CTrans].error)
+            {
+                cntError++;
+                //TODO error handling
+                rtcStatus |= RTS_SET_I2C; //Retry  forever DEBUG
+            }
+            rtcStatus ^= RTS_SET_I2C_INP;
+        }
+    }
+    else if (0 != (rtcStatus & RTS_SET_MAIN))
+    {
+        if(I2C_BUFFER_SIZE > (3 + RING_LEN(buffI2CRead, buffI2CWrite, I2C_BUFFER_SIZE)))
+        {
+            curRTSI2CTrans = buffI2CWrite;
+            buffI2CWrite = RING_ADD(buffI2CWrite, 2, I2C_BUFFER_SIZE);
+            
+            buffI2C[curRTSI2CTrans].type = I2C_WRITE;
+            buffI2C[curRTSI2CTrans].slaveAddress = I2C_ADDRESS_RTC;
+            buffI2C[curRTSI2CTrans].data = dataRTCI2C;
+            buffI2C[curRTSI2CTrans].cnt = 1;
+            buffI2C[curRTSI2CTrans].mode = I2C_RTC_MODE_COMPLETE_XFER;
+    //        buffI2C[curRTSI2CTrans].mode = I2C_RTC_MODE_NO_STOP;
+            
+            uint8 curRTSI2CTrans2 = RING_INC(curRTSI2CTrans, I2C_BUFFER_SIZE);
+            buffI2C[curRTSI2CTrans2].type = I2C_READ;
+            buffI2C[curRTSI2CTrans2].slaveAddress = I2C_ADDRESS_RTC;
+            buffI2C[curRTSI2CTrans2].data = (dataRTCI2C + 1); //0 element is register address to write
+            buffI2C[curRTSI2CTrans2].cnt = 7;
+            buffI2C[curRTSI2CTrans2].mode = I2C_RTC_MODE_COMPLETE_XFER;
+            rtcStatus |= RTS_SET_MAIN_INP;
+            rtcStatus ^= RTS_SET_MAIN;
+        }
+    }
+    else if (0 != (rtcStatus & RTS_SET_I2C))
+    {
+        if(I2C_BUFFER_SIZE > (2 + RING_LEN(buffI2CRead, buffI2CWrite, I2C_BUFFER_SIZE)))
+        {
+            curRTSI2CTrans = buffI2CWrite;
+            buffI2CWrite = RING_INC(buffI2CWrite, I2C_BUFFER_SIZE);
+            
+            RTC_Main_DisableInt();
+            mainTimeDateSysPtr = RTC_Main_ReadTime();
+            memcpy(&mainTimeDate, mainTimeDateSysPtr, sizeof(mainTimeDate));// make local copy before changes
+            RTC_Main_EnableInt();
+            
+            dataRTCI2C[1] = (Dec2BCD(mainTimeDate.Sec) & 0x7F) | 0x80; //0x80 enables Oscillator
+            dataRTCI2C[2] = Dec2BCD(mainTimeDate.Min) & 0x7F;
+            dataRTCI2C[3] = Dec2BCD(mainTimeDate.Hour) & 0x3F;
+            dataRTCI2C[4] = (Dec2BCD(mainTimeDate.DayOfWeek - 1) & 0x07) | 0x08; //DayOfWeek starts at 1. 0x08 enables external battery
+            dataRTCI2C[5] = Dec2BCD(mainTimeDate.DayOfMonth) & 0x3F;
+            dataRTCI2C[6] = Dec2BCD(mainTimeDate.Month) & 0x1F;
+            dataRTCI2C[7] = Dec2BCD((uint8)(mainTimeDate.Year % 100));
+            
+            buffI2C[curRTSI2CTrans].type = I2C_WRITE;
+            buffI2C[curRTSI2CTrans].slaveAddress = I2C_ADDRESS_RTC;
+            buffI2C[curRTSI2CTrans].data = dataRTCI2C;
+            buffI2C[curRTSI2CTrans].cnt = 8;
+            buffI2C[curRTSI2CTrans].mode = I2C_RTC_MODE_COMPLETE_XFER;
+            
+            rtcStatus |= RTS_SET_I2C_INP;
+            rtcStatus ^= RTS_SET_I2C;
+        }
+    }
+    else if (0 != (rtcStatus & RTS_SET_EVENT))
+    {
+        uint8 tmpOrder = orderBuffCmd[0];
+        if (WAIT_DLE != commandStatusC[tmpOrder]) //a packet being parsed is written past writeBuffCmd, queue between packets
+        {
+            return 0; //RTS_SET_EVENT stays set, tried again next pass
+        }
+        if (CMD_BUFFER_SIZE <= (RING_LEN(readBuffCmd[tmpOrder], writeBuffCmd[tmpOrder], CMD_BUFFER_SIZE) + 11)) //check if space for commands
+        {
+            cntError++;
+            //TODO errr log
+            return -ENOMEM;
+        }
+        //TOD0 check that this doesn't pass read index in the command buffer
+        uint8 tmpWrite = writeBuffCmd[tmpOrder];
+        RTC_Main_DisableInt();
+        mainTimeDateSysPtr = RTC_Main_ReadTime();
+        memcpy(&mainTimeDate, mainTimeDateSysPtr, sizeof(mainTimeDate));// make local copy before changes
+        RTC_Main_EnableInt();
+        buffCmd[tmpOrder][tmpWrite][0] = 0x45; //Set RTC command
+        buffCmd[tmpOrder][tmpWrite][1] = 0xA2; //8 Address, 10 bytes
+        tmpWrite = RING_INC(tmpWrite, CMD_BUFFER_SIZE);
+        buffCmd[tmpOrder][tmpWrite][0] = mainTimeDate.Sec; //Sec
+        buffCmd[tmpOrder][tmpWrite][1] = 0x21; //byte #1
+        tmpWrite = RING_INC(tmpWrite, CMD_BUFFER_SIZE);
+        buffCmd[tmpOrder][tmpWrite][0] = mainTimeDate.Min; //Min
+        buffCmd[tmpOrder][tmpWrite][1] = 0x22; //byte #2
+        tmpWrite = RING_INC(tmpWrite, CMD_BUFFER_SIZE);
+        buffCmd[tmpOrder][tmpWrite][0] = mainTimeDate.Hour; //Hour
+        buffCmd[tmpOrder][tmpWrite][1] = 0x23; //byte #3
+        tmpWrite = RING_INC(tmpWrite, CMD_BUFFER_SIZE);
+        buffCmd[tmpOrder][tmpWrite][0] = mainTimeDate.DayOfWeek; //DayOfWeek
+        buffCmd[tmpOrder][tmpWrite][1] = 0x60; //byte #4
+        tmpWrite = RING_INC(tmpWrite, CMD_BUFFER_SIZE);
+        buffCmd[tmpOrder][tmpWrite][0] = mainTimeDate.DayOfMonth; //DayOfMonth
+        buffCmd[tmpOrder][tmpWrite][1] = 0x61; //byte #5
+        tmpWrite = RING_INC(tmpWrite, CMD_BUFFER_SIZE);
+        buffCmd[tmpOrder][tmpWrite][0] = *((uint8*)(((uint8*) &(mainTimeDate.DayOfYear)) + 1)); //DayOfYear MSB Little endian to Big endian conversion in the precomplier
+        buffCmd[tmpOrder][tmpWrite][1] = 0x62; //byte #6
+        tmpWrite = RING_INC(tmpWrite, CMD_BUFFER_SIZE);
+        buffCmd[tmpOrder][tmpWrite][0] = *((uint8*) &(mainTimeDate.DayOfYear)); //DayOfYear LSB Little endian to Big endian conversion in the precomplier
+        buffCmd[tmpOrder][tmpWrite][1] = 0x63; //byte #7
+        tmpWrite = RING_INC(tmpWrite, CMD_BUFFER_SIZE);
+        buffCmd[tmpOrder][tmpWrite][0] = mainTimeDate.Month; //DayOfMonth
+        buffCmd[tmpOrder][tmpWrite][1] = 0xA0; //byte #8
+        tmpWrite = RING_INC(tmpWrite, CMD_BUFFER_SIZE);
+        buffCmd[tmpOrder][tmpWrite][0] = *((uint8*)(((uint8*) &(mainTimeDate.Year)) + 1)); //DayOfYear MSB Little endian to Big endian conversion in the precomplier
+        buffCmd[tmpOrder][tmpWrite][1] = 0xA1; //byte #9
+        tmpWrite = RING_INC(tmpWrite, CMD_BUFFER_SIZE);
+        buffCmd[tmpOrder][tmpWrite][0] = *((uint8*) &(mainTimeDate.Year)); //DayOfYear LSB Little endian to Big endian conversion in the precomplier
+        buffCmd[tmpOrder][tmpWrite][1] = 0xA2; //byte #10
+        RING_PUBLISH();
+        writeBuffCmd[tmpOrder] = RING_ADD(writeBuffCmd[tmpOrder], 11, CMD_BUFFER_SIZE);
+        loopEvent[LOOP_EV_CMD] = TRUE;
+
+        rtcStatus ^= RTS_SET_EVENT;
+    }
+    else if (0 != (rtcStatus & RTS_SET_RPI))
+    {
+    
+        //TODO Rpi commands
+        
+        rtcStatus ^= RTS_SET_RPI;
+    }
+    return 0;
+}
+
+CY_ISR(ISRBaroCap)
+{
+//	isr_B_ClearPending();
+//    Pin_CE1_Write(1); //DEBUG
+	uint8 continueCheck = FALSE;
+//	uint8 n =0;
+    //DEBUG
+//    for(uint8 x =0; x<4; x++) buffBaroCapNum[x][buffBaroCapNumWrite] = 0;//DEBUG
+	do {
+		uint8 i = 0;
+//		uint tempStatus = Counter_BaroTemp1_ReadStatusRegister();
+//		UART_HR_Data_PutChar(Counter_BaroTemp1_STATUS_FIFONEMP);
+//		UART_HR_Data_PutChar(tempStatus);
+//		UART_HR_Data_PutChar(Counter_BaroTemp1_STATUS_FIFONEMP & tempStatus);
+//		Counter_BaroTemp1_ReadCapture();
+		continueCheck = FALSE;
+		if (0 != (Counter_BaroTemp1_STATUS_FIFONEMP & Counter_BaroTemp1_ReadStatusRegister()))
+		{
+			continueCheck = TRUE;
+			buffBaroCap[i][buffBaroCapWrite[i]] = Counter_BaroTemp1_ReadCapture();
+			buffBaroCapWrite[i] = RING_INC(buffBaroCapWrite[i], NUM_BARO_CAPTURES);
+//            buffBaroCapNum[i][buffBaroCapNumWrite]++; //DEBUG
+		}
+		i = 2;
+		if (0 != (Counter_BaroTemp2_STATUS_FIFONEMP & Counter_BaroTemp2_ReadStatusRegister()))
+		{
+			continueCheck = TRUE;
+			buffBaroCap[i][buffBaroCapWrite[i]] = Counter_BaroTemp2_ReadCapture();
+			buffBaroCapWrite[i] = RING_INC(buffBaroCapWrite[i], NUM_BARO_CAPTURES);
+//            buffBaroCapNum[i][buffBaroCapNumWrite]++;//DEBUG
+		}
+		i = 1;
+		if (0 != (Counter_BaroPres1_STATUS_FIFONEMP & Counter_BaroPres1_ReadStatusRegister()))
+		{
+			continueCheck = TRUE;
+			buffBaroCap[i][buffBaroCapWrite[i]] = Counter_BaroPres1_ReadCapture();
+			buffBaroCapWrite[i] = RING_INC(buffBaroCapWrite[i], NUM_BARO_CAPTURES);
+//            buffBaroCapNum[i][buffBaroCapNumWrite]++; //DEBUG
+		}
+		i = 3;
+		if (0 != (Counter_BaroPres2_STATUS_FIFONEMP & Counter_BaroPres2_ReadStatusRegister()))
+		{
+			continueCheck = TRUE;
+			buffBaroCap[i][buffBaroCapWrite[i]] = Counter_BaroPres2_ReadCapture();
+			buffBaroCapWrite[i] = RING_INC(buffBaroCapWrite[i], NUM_BARO_CAPTURES);
+//            buffBaroCapNum[i][buffBaroCapNumWrite]++; //DEBUG
+		}
+//		n++;
+	} while(continueCheck);
+//    if (buffBaroCapNumWrite >= (NUM_BARO_CAPTURES - 1))//DEBUG
+//    {
+//        buffBaroCapNumWrite = 0 ;
+//    }
+//    else
+//    {
+//        buffBaroCapNumWrite++;//DEBUG
+//	}
+    //TODO Packing of Baro values along with thers like voltage.  For now just dump it to stream
+//	UART_HR_Data_PutChar(DUMP_HEAD);
+//	UART_HR_Data_PutChar(n);
+//	UART_HR_Data_PutArray((uint8*) buffBaroCap, sizeof(buffBaroCap));
+//	UART_HR_Data_PutChar(ENDDUMP_HEAD);
+//	for (uint8 i=0;i<(NUM_BARO *2); i++) buffBaroCapRead[i] = buffBaroCapWrite[i];
+    for (uint8 i=0;i<(NUM_BARO); i++) 
+    {
+        uint8 n = i << 1;
+        uint16 temp16;
+//        uint16 last16 =(uint16)(curBaroTempCnt[i] & 0xFFFF);
+        uint16 last16 = buffBaroCap[n][RING_DEC( buffBaroCapRead[n] , NUM_BARO_CAPTURES)];
+//        uint8 numRollover = 0;
+        while(buffBaroCapRead[n] != buffBaroCapWrite[n])
+        {
+            temp16 = buffBaroCap[n][buffBaroCapRead[n]];
+            if ( last16 > temp16)
+            {
+//                curBaroTempCnt[i] += 0x10000; // rollover, increment upper MSB
+//                numRollover++;
+                curBaroTempCnt[i] += (uint32)(BARO_COUNT_MAX - last16); //add the rest of counter before rollover
+                curBaroTempCnt[i] += (uint32)(temp16); //add counter after rollover
+            }
+            else
+            {
+                curBaroTempCnt[i] += (uint32)(temp16 - last16); //add counter after rollover
+            }
+            buffBaroCapRead[n] = RING_INC( buffBaroCapRead[n] , NUM_BARO_CAPTURES);
+            last16 = temp16;
+//            if (buffBaroCapRead[n] == buffBaroCapWrite[n])
+//            {
+//                curBaroTempCnt[i] &= 0xFFFF0000;
+//                curBaroTempCnt[i] |= temp16;
+//            }
+//            else
+//            {
+//                last16 = temp16;
+//            }
+        }
+//        for (uint8 x=0;x<numRollover; x++) curBaroTempCnt[i] += 0xFFFE; // period of the 16 bit counter maxes out at 65534 so add that per rollover, counter immediately turns to 0 at that count and counts up to 1 next baro pulse
+        n++;
+        last16 = buffBaroCap[n][RING_DEC( buffBaroCapRead[n] , NUM_BARO_CAPTURES)];
+//        last16 =(uint16)(curBaroPresCnt[i] & 0xFFFF);
+//        numRollover = 0;
+        while(buffBaroCapRead[n] != buffBaroCapWrite[n])
+        {
+            temp16 = buffBaroCap[n][buffBaroCapRead[n]];
+            if ( last16 > temp16)
+            {
+//                curBaroPresCnt[i] += 0x10000; // rollover, increment upper MSB
+//                numRollover++;
+                curBaroPresCnt[i] += (uint32)(BARO_COUNT_MAX - last16); //add the rest of counter before rollover
+                curBaroPresCnt[i] += (uint32)(temp16); //add counter after rollover
+            }
+            else
+            {
+                curBaroPresCnt[i] += (uint32)(temp16 - last16); //add counter after rollover
+            }
+            buffBaroCapRead[n] = RING_INC( buffBaroCapRead[n] , NUM_BARO_CAPTURES);
+            last16 = temp16;
+//            if (buffBaroCapRead[n] == buffBaroCapWrite[n])
+//            {
+//                curBaroPresCnt[i] &= 0xFFFF0000;
+//                curBaroPresCnt[i] |= temp16;
+//            }
+//            else
+//            {
+//                last16 = temp16;
+//            }
+        }
+//        for (uint8 x=0;x<numRollover; x++) curBaroPresCnt[i] += 0xFFFE; // period of the 16 bit counter maxes out at 65534 so add that per rollover, counter immediately turns to 0 at that count and counts up to 1 next baro pulse
+    }
+//	uint8 tmpSecs =  hkSecs << 1; //ISR is now 2Hz so need to adjust hkSecs to match
+	uint8 tmpSecs =  hkSecs << 2; //ISR is now 4Hz so need to adjust hkSecs to match
+//	Pin_CE1_Write(cntSecs % 2); //DEBUG timing on scope
+    if (0 == (cntSecs % tmpSecs))
+    {
+        RTC_Main_DisableInt();
+        mainTimeDateSysPtr = RTC_Main_ReadTime();
+        memcpy(&mainTimeDate, mainTimeDateSysPtr, sizeof(mainTimeDate));// copy to local struct before update
+        RTC_Main_EnableInt();
+        hkReq = TRUE;//request a new housekeeping packet
+        if ((255 - cntSecs) <= tmpSecs)
+        {
+            cntSecs=1;// reset to 1 before the rollover to 0 causes incosistant interval timing
+        }
+        else
+        {
+            cntSecs++;
+        }
+        uint32 temp32 = curBaroTempCnt[0];
+//        int8 i=2; //24bit for Counter1 style packet DEBUG
+        int8 i=3; //32bit 
+        buffHK[buffHKWrite].baroTemp1[i] = temp32 & 0xFF; // to make this endian independent and output as big endian, fill the LSB first
+        while (0 <= --i) //Fill the Higher order bytes
+        {
+            temp32 >>= 8;
+            buffHK[buffHKWrite].baroTemp1[i] = temp32 & 0xFF;
+        }
+        temp32 = curBaroPresCnt[0];
+        i=3; //32bit
+//        i=2; //24bit for Counter1 style packet DEBUG
+        buffHK[buffHKWrite].baroPres1[i] = temp32 & 0xFF; // to make this endian independent and output as big endian, fill the LSB first
+        while (0 <= --i) //Fill the Higher order bytes
+        {
+            temp32 >>= 8;
+            buffHK[buffHKWrite].baroPres1[i] = temp32 & 0xFF;
+        }
+        temp32 = curBaroTempCnt[1];
+        i=3; //32bit
+//        i=2; //24bit for Counter1 style packet DEBUG
+        buffHK[buffHKWrite].baroTemp2[i] = temp32 & 0xFF; // to make this endian independent and output as big endian, fill the LSB first
+        while (0 <= --i) //Fill the Higher order bytes
+        {
+            temp32 >>= 8;
+            buffHK[buffHKWrite].baroTemp2[i] = temp32 & 0xFF;
+        }
+        temp32 = curBaroPresCnt[1];
+        i=3; //32bit
+//        i=2; //24bit for Counter1 style packet DEBUG
+        buffHK[buffHKWrite].baroPres2[i] = temp32 & 0xFF; // to make this endian independent and output as big endian, fill the LSB first
+        while (0 <= --i) //Fill the Higher order bytes
+        {
+            temp32 >>= 8;
+            buffHK[buffHKWrite].baroPres2[i] = temp32 & 0xFF;
+        }
+        
+        temp32 = (uint32)(mainTimeDate.Year % 2000) << 4;
+        temp32 |= mainTimeDate.Month;
+        temp32 <<= 5;//shift left to make room for new bits;
+        temp32 |= mainTimeDate.DayOfMonth;
+        temp32 <<= 5;//shift left to make room for new bits;
+        temp32 |= mainTimeDate.Hour;
+        temp32 <<= 6;//shift left to make room for new bits;
+        temp32 |= mainTimeDate.Min;
+        temp32 <<= 6;//shift left to make room for new bits;
+        temp32 |= mainTimeDate.Sec;
+        
+//        temp32 = 60 * ( ( 60 * mainTimeDate.Hour) + mainTimeDate.Min ) + mainTimeDate.Sec; // Convert RTC to secs
+        i=3; //32bit
+//        i=2; //24bit for Counter1 style packet DEBUG
+        buffHK[buffHKWrite].packedTimeDate[i] = temp32 & 0xFF; // to make this endian independent and output as big endian, fill the LSB first
+        while (0 <= --i) //Fill the Higher order bytes
+        {
+            temp32 >>= 8;
+            buffHK[buffHKWrite].packedTimeDate[i] = temp32 & 0xFF;
+        }
+
+    }
+    else
+    {
+        cntSecs++;
+    }
+//    Pin_CE1_Write(0); //DEBUG
+    
+}
+
+/* [] END OF FILE */
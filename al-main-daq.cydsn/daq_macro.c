@@ -0,0 +1,251 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Command macros: up to CMD_MACROS sequences of commands recorded from the
+ * ground with Main PSOC commands 0x54 (begin), 0x55 (append) and 0x56 (save),
+ * then run with the single command CMD_MACRO_RUN_ID + slot.
+ * A run is queued to command source 0 a few commands each pass as there is
+ * room, so it never needs the whole macro free in buffCmd. Commands to the
+ * Main PSOC in a macro are interpreted like any other, a macro cannot run one.
+ * The slots are run from SRAM and kept over resets in the on-chip EEPROM.
+ * A save writes the rows in use with cy_boot CyWriteRowData, one row a pass,
+ * each blocks the main loop for the row erase and program (up to 20 ms), the
+ * interrupts keep running. At start the slots are read back from the EEPROM
+ * and one whose sum fails, a save cut short by a reset, starts empty.
+ * Slots are numbered, not named, a name does not fit the 2 byte commands.
+ *
+ * ========================================
+*/
+
+#include "daq.h"
+
+typedef char cmdMacroAssertEEPROM[(CYDEV_EE_SIZE >= (CMD_MACROS * CMD_MACRO_SIZE)) ? 1 : -1]; //compile error if the slots do not fit the EEPROM
+
+CmdMacro cmdMacro[CMD_MACROS]; //the slots, copy of the EEPROM ones
+CmdMacro cmdMacroEdit; //macro being recorded
+uint8 cmdMacroEditSlot = CMD_MACROS; //slot cmdMacroEdit is recorded for, CMD_MACROS none
+uint8 cmdMacroRunSlot = CMD_MACROS; //slot being queued to buffCmd, CMD_MACROS none
+uint8 cmdMacroRunPos = 0; //next command of the slot to queue
+uint8 cmdMacroSaveSlot = CMD_MACROS; //slot being written to the EEPROM, CMD_MACROS none
+static uint8 cmdMacroSaveRow = 0; //next row of the slot to write
+static uint8 cmdMacroSaveRows = 0; //rows holding the header and commands
+uint8 cmdMacroSavePending = 0; //slots saved and not yet written to the EEPROM, one bit each
+
+/**
+ * @brief Sums the header and command bytes of a macro, 0 for a macro saved whole
+ */
+static uint8 SumCmdMacro(const CmdMacro * macro)
+{
+    uint8 sum = macro->numCmds + macro->sum;
+    for (uint8 x = 0; x < macro->numCmds; x++)
+    {
+        sum += macro->cmd[x][0] + macro->cmd[x][1];
+    }
+    return sum;
+}
+
+/**
+ * @brief Starts the EEPROM and loads the slots saved in it, a slot that fails its sum starts empty
+ */
+void InitCmdMacros()
+{
+    CyEEPROM_Start();
+    memcpy(cmdMacro, (const void *)CYDEV_EE_BASE, sizeof(cmdMacro)); //the EEPROM reads as memory
+    for (uint8 slot = 0; slot < CMD_MACROS; slot++)
+    {
+        if ((CMD_MACRO_CMDS < cmdMacro[slot].numCmds) || (0 != SumCmdMacro(&cmdMacro[slot])))
+        {
+            memset(&cmdMacro[slot], 0, sizeof(CmdMacro));
+        }
+    }
+    cmdMacroEditSlot = cmdMacroRunSlot = cmdMacroSaveSlot = CMD_MACROS;
+    cmdMacroSavePending = 0;
+}
+
+/**
+ * @brief Starts recording a macro for slot, anything recorded and not saved is dropped
+ * @return int 0, -EINVAL no such slot
+ */
+int BeginCmdMacro(uint8 slot)
+{
+    if (CMD_MACROS <= slot)
+    {
+        cntCmdError++;
+        return -EINVAL;
+    }
+    cmdMacroEdit.numCmds = 0;
+    cmdMacroEditSlot = slot;
+    return 0;
+}
+
+/**
+ * @brief Appends commands, data byte then address byte, to the macro being recorded
+ * @details A command running a macro is refused, a macro could then run itself forever.
+ * @return int 0, -EINVAL odd bytes or a macro run, -ENOENT no macro is being recorded, -ENOSPC the macro is full
+ */
+int AppendCmdMacro(const uint8 * cmds, uint8 numBytes)
+{
+    if (CMD_MACROS <= cmdMacroEditSlot)
+    {
+        cntCmdError++;
+        return -ENOENT;
+    }
+    if (0 != (numBytes & 1))
+    {
+        cntCmdError++;
+        return -EINVAL;
+    }
+    for (uint8 x = 0; x < numBytes; x += 2)
+    {
+        if ((CMD_MAIN_PSOC_ADDRESS == cmds[x + 1]) && (CMD_MACRO_RUN_ID <= cmds[x]) && ((CMD_MACRO_RUN_ID + CMD_MACROS) > cmds[x]))
+        {
+            cntCmdError++;
+            return -EINVAL;
+        }
+    }
+    if ((CMD_MACRO_CMDS - cmdMacroEdit.numCmds) < (numBytes / 2))
+    {
+        cntCmdError++;
+        return -ENOSPC;
+    }
+    memcpy(cmdMacroEdit.cmd[cmdMacroEdit.numCmds], cmds, numBytes);
+    cmdMacroEdit.numCmds += numBytes / 2;
+    return 0;
+}
+
+/**
+ * @brief Saves the macro recorded to its slot, CheckCmdMacros then writes the slot to the EEPROM
+ * @details A slot saved again while its rows are written is written over from the first row.
+ * @return int 0, -ENOENT no macro is being recorded, -EBUSY the slot is being run
+ */
+int SaveCmdMacro()
+{
+    if (CMD_MACROS <= cmdMacroEditSlot)
+    {
+        cntCmdError++;
+        return -ENOENT;
+    }
+    if (cmdMacroEditSlot == cmdMacroRunSlot)
+    {
+        cntCmdError++;
+        return -EBUSY;
+    }
+    cmdMacroEdit.sum = 0;
+    cmdMacroEdit.sum = -SumCmdMacro(&cmdMacroEdit);
+    memcpy(&cmdMacro[cmdMacroEditSlot], &cmdMacroEdit, sizeof(CmdMacro));
+    if (cmdMacroEditSlot == cmdMacroSaveSlot)
+    {
+        cmdMacroSaveSlot = CMD_MACROS;
+    }
+    cmdMacroSavePending |= 1u << cmdMacroEditSlot;
+    cmdMacroEditSlot = CMD_MACROS;
+    return 0;
+}
+
+/**
+ * @brief Starts queueing the commands of a slot to command source 0
+ * @return int 0, -EINVAL no such slot, -EBUSY a macro is running, -ENODATA the slot is empty
+ */
+int RunCmdMacro(uint8 slot)
+{
+    if (CMD_MACROS <= slot)
+    {
+        cntCmdError++;
+        return -EINVAL;
+    }
+    if (CMD_MACROS > cmdMacroRunSlot)
+    {
+        cntCmdError++;
+        return -EBUSY;
+    }
+    const CmdMacro * macro = &cmdMacro[slot];
+    if ((0 == macro->numCmds) || (CMD_MACRO_CMDS < macro->numCmds) || (0 != SumCmdMacro(macro)))
+    {
+        cntCmdError++;
+        return -ENODATA;
+    }
+    cmdMacroRunPos = 0;
+    cmdMacroRunSlot = slot;
+    return 0;
+}
+
+/**
+ * @brief Writes the next EEPROM row of the slot being saved, or starts on the next slot saved
+ * @details The die temperature the write is compensated with is read once a slot. A slot whose
+ * write fails stays in SRAM, its EEPROM copy fails the sum at the next start.
+ */
+static void CheckCmdMacroSave()
+{
+    if (CMD_MACROS <= cmdMacroSaveSlot)
+    {
+        uint8 slot = 0;
+        while (0 == (cmdMacroSavePending & (1u << slot))) slot++;
+        cmdMacroSavePending &= ~(1u << slot);
+        if (CYRET_SUCCESS != CySetTemp())
+        {
+            cntError++;
+            return;
+        }
+        cmdMacroSaveSlot = slot;
+        cmdMacroSaveRow = 0;
+        cmdMacroSaveRows = (2u + (2u * cmdMacro[slot].numCmds) + CYDEV_EEPROM_ROW_SIZE - 1u) / CYDEV_EEPROM_ROW_SIZE; //the rest of the slot is left as it is
+    }
+    if (CYRET_SUCCESS != CyWriteRowData(CY_SPC_FIRST_EE_ARRAYID, (cmdMacroSaveSlot * CMD_MACRO_ROWS) + cmdMacroSaveRow,
+                                        &((const uint8 *)&cmdMacro[cmdMacroSaveSlot])[cmdMacroSaveRow * CYDEV_EEPROM_ROW_SIZE]))
+    {
+        cntError++;
+        cmdMacroSaveSlot = CMD_MACROS;
+        return;
+    }
+    cmdMacroSaveRow++;
+    if (cmdMacroSaveRows <= cmdMacroSaveRow)
+    {
+        cmdMacroSaveSlot = CMD_MACROS;
+    }
+}
+
+/**
+ * @brief Steps a macro save and queues the next commands of a macro run to command source 0
+ * @details Source 0 is only written between ground command packets, the parser would drop a packet
+ * that had a macro command queued in the middle of it. At most CMD_MACRO_CHUNK commands a pass.
+ * @return int commands queued
+ */
+int CheckCmdMacros()
+{
+    if ((CMD_MACROS > cmdMacroSaveSlot) || (0 != cmdMacroSavePending))
+    {
+        CheckCmdMacroSave();
+    }
+    if (CMD_MACROS <= cmdMacroRunSlot) return 0;
+    const CmdMacro * macro = &cmdMacro[cmdMacroRunSlot];
+    if (WAIT_DLE != commandStatusC[0]) //CheckLRCmd is in the middle of a packet of source 0
+    {
+        return 0;
+    }
+    uint8 tmpWrite = writeBuffCmd[0];
+    uint8 n = MIN(MIN(RING_FREE(readBuffCmd[0], tmpWrite, CMD_BUFFER_SIZE), CMD_MACRO_CHUNK), macro->numCmds - cmdMacroRunPos);
+    for (uint8 x = 0; x < n; x++)
+    {
+        buffCmd[0][tmpWrite][0] = macro->cmd[cmdMacroRunPos][0];
+        buffCmd[0][tmpWrite][1] = macro->cmd[cmdMacroRunPos][1];
+        tmpWrite = RING_INC(tmpWrite, CMD_BUFFER_SIZE);
+        cmdMacroRunPos++;
+    }
+    RING_PUBLISH();
+    writeBuffCmd[0] = tmpWrite;
+    if (macro->numCmds <= cmdMacroRunPos)
+    {
+        cmdMacroRunSlot = CMD_MACROS;
+    }
+    return n;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,156 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Timing and buffer occupancy of the DAQ stages. The DWT cycle counter of the
+ * Cortex-M3 is the free running timer, so no TopDesign component is used.
+ * TRACE_START / TRACE_END around a stage keep calls, last and peak cycles in
+ * traceTiming, TRACE_PEAK keeps the most elements seen in use in tracePeak.
+ * The main loop pass also goes into the log2 histogram loopHist.
+ * Each HK packet is followed by a DiagnosticPeriodic (DIAG_HEAD) with the
+ * totals since the last one, then the counts and peaks restart.
+ * Stage times include any ISRs that ran during the stage.
+ *
+ * ========================================
+*/
+
+#include "daq.h"
+
+TraceTiming traceTiming[TRACE_STAGES];
+uint16 tracePeak[TRACE_PEAKS];
+uint32 loopHist[LOOP_HIST_BUCKETS];
+DiagnosticPeriodic buffDiag;
+uint8 diagReady = FALSE; //buffDiag is filled and waiting for the frames
+uint8 diagIntervals = 0; //HK packets made, the sequence of the diagnostic packet
+
+/**
+ * @brief Starts the DWT cycle counter, clears the trace and presets the diagnostic packet header and EOR
+ * @details The counter runs with DAQ_TRACE 0 too, the main loop budget uses it.
+ */
+void InitTrace()
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; //DWT is off until trace is enabled
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    memset(traceTiming, 0, sizeof(traceTiming));
+    memset(tracePeak, 0, sizeof(tracePeak));
+    memset(loopHist, 0, sizeof(loopHist));
+    memset(&buffDiag, 0, sizeof(buffDiag));
+    buffDiag.header[0] = DIAG_HEAD;
+    memcpy(buffDiag.header + 1, frame00FF, 2);
+    buffDiag.clockMHz = BCLK__BUS_CLK__HZ / 1000000u;
+    buffDiag.EOR[0] = EOR_HEAD;
+    memcpy(buffDiag.EOR + 1, frame00FF, 2);
+    diagReady = FALSE;
+    diagIntervals = 0;
+}
+
+/**
+ * @brief Ends the timing of a stage started at start
+ * @details Called from the ISRs too, each stage has a single caller so there is no critical section.
+ */
+void TraceEnd(uint8 stage, uint32 start)
+{
+    uint32 cycles = TRACE_NOW() - start; //unsigned so the counter wrap is fine
+    traceTiming[stage].last = cycles;
+    if (cycles > traceTiming[stage].peak)
+    {
+        traceTiming[stage].peak = cycles;
+    }
+    traceTiming[stage].calls++;
+}
+
+/**
+ * @brief Ends the timing of a main loop pass started at start and adds it to loopHist
+ */
+void TraceLoopEnd(uint32 start)
+{
+    uint32 cycles = TRACE_NOW() - start;
+    TraceEnd(TRACE_MAIN_LOOP, start);
+    uint8 bucket = 0;
+    if (256u <= cycles)
+    {
+        bucket = MIN(31u - __CLZ(cycles) - 7u, LOOP_HIST_BUCKETS - 1u); //bit 8 set is bucket 1
+    }
+    loopHist[bucket]++;
+}
+
+/**
+ * @brief Samples the occupancy of packetEv, buffSPI, buffCmd and buffI2C
+ * @details Called by the main loop after CheckEventPackets queued to packetEv and before any of
+ * these are read, so it sees them at their fullest for the pass. buffEv is sampled by CheckEventPackets.
+ */
+void TraceOccupancy()
+{
+#if DAQ_TRACE
+    TRACE_PEAK(TRACE_PEAK_PACKET_EV, RING_LEN(packetEvHead, packetEvTail, PACKET_EVENT_SIZE));
+    for (uint8 i = 0; i < NUM_SPI_DEV; i++)
+    {
+        TRACE_PEAK(TRACE_PEAK_SPI, RING_LEN(buffSPIRead[i], buffSPIWrite[i], tabSPIDev[i].size));
+    }
+    for (uint8 i = 0; i < COMMAND_SOURCES; i++)
+    {
+        TRACE_PEAK(TRACE_PEAK_CMD, RING_LEN(readBuffCmd[i], writeBuffCmd[i], CMD_BUFFER_SIZE));
+    }
+    TRACE_PEAK(TRACE_PEAK_I2C, RING_LEN(buffI2CRead, buffI2CWrite, I2C_BUFFER_SIZE));
+#endif
+}
+
+#if DAQ_TRACE
+/**
+ * @brief Writes the 3 LSB of val MSB first, saturated at 0xFFFFFF
+ */
+static void PutTrace24(uint8 * dst, uint32 val)
+{
+    val = MIN(val, 0xFFFFFFu);
+    dst[0] = (val >> 16) & 0xFF;
+    dst[1] = (val >> 8) & 0xFF;
+    dst[2] = val & 0xFF;
+}
+#endif
+
+/**
+ * @brief Copies the trace into buffDiag for the frames and restarts the counts and peaks
+ * @details Skipped while the last packet is still waiting for the frames, the trace keeps
+ * counting and goes out in the next one, sequence shows the merge.
+ */
+void FillDiagPacket()
+{
+#if DAQ_TRACE
+    diagIntervals++;
+    if (TRUE == diagReady) return;
+    buffDiag.sequence = diagIntervals;
+    for (uint8 i = 0; i < TRACE_STAGES; i++)
+    {
+        TraceTiming tmpTiming = traceTiming[i]; //ISR stages can update during the copy, at worst one call is off
+        traceTiming[i].calls = 0;
+        traceTiming[i].peak = 0;
+        PutTrace24(&buffDiag.stage[i][0], tmpTiming.calls);
+        PutTrace24(&buffDiag.stage[i][3], tmpTiming.last);
+        PutTrace24(&buffDiag.stage[i][6], tmpTiming.peak);
+    }
+    for (uint8 i = 0; i < TRACE_PEAKS; i++)
+    {
+        buffDiag.occupancyPeak[i][0] = (tracePeak[i] >> 8) & 0xFF;
+        buffDiag.occupancyPeak[i][1] = tracePeak[i] & 0xFF;
+        tracePeak[i] = 0;
+    }
+    for (uint8 i = 0; i < LOOP_HIST_BUCKETS; i++)
+    {
+        PutTrace24(buffDiag.loopHist[i], loopHist[i]);
+        loopHist[i] = 0;
+    }
+    PutTrace24(buffDiag.loopYields, cntLoopYields);
+    cntLoopYields = 0;
+    diagReady = TRUE;
+#endif
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,46 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Power of two ring buffers. A ring is a statically sized array plus a read
+ * and a write index, like buffEv / buffEvRead / buffEvWrite. With the size a
+ * power of two every wrap is a mask instead of the divide WRAP and ACTIVELEN
+ * need for sizes like FRAME_BUFFER_SIZE, and the index math stays correct with
+ * unsigned overflow.
+ *
+ * One slot is always left empty so read == write means empty, full is
+ * RING_FREE == 0. A ring is single producer / single consumer safe without a
+ * critical section as long as only the producer writes the write index, only
+ * the consumer writes the read index, the indices shared with an ISR are
+ * volatile, the producer stores its index after the data behind RING_PUBLISH,
+ * and the consumer snapshots the index then RING_CONSUME before reading data.
+ *
+ * ========================================
+*/
+
+#ifndef RING_H
+#define RING_H
+
+#define RING_IS_POW2(size) ((0u != (size)) && (0u == ((size) & ((size) - 1u))))
+#define RING_ASSERT_POW2(size, name) typedef char ringAssert_##name[RING_IS_POW2(size) ? 1 : -1] //compile error if size is not a power of 2
+
+#define RING_MASK(size) ((size) - 1u)
+#define RING_WRAP(a,size) ((a) & RING_MASK(size)) //bring a calculated index a into the ring
+#define RING_INC(a,size) RING_WRAP((a) + 1u, size)
+#define RING_DEC(a,size) RING_WRAP((a) + RING_MASK(size), size)
+#define RING_ADD(a,n,size) RING_WRAP((a) + (n), size)
+#define RING_LEN(read,write,size) RING_WRAP((write) - (read), size) //active elements from read up to write, exclusive
+#define RING_FREE(read,write,size) (RING_MASK(size) - RING_LEN(read, write, size)) //elements that can be written before write reaches read
+#define RING_SPAN(read,write,size) (((write) >= (read)) ? ((write) - (read)) : ((size) - (read))) //active elements readable at read without a wrap, for memcpy
+#define RING_PUBLISH() __DMB() //producer: data stores are done before the index store that hands them over
+#define RING_CONSUME() __DMB() //consumer: index load is done before the data loads it covers
+
+#endif /* RING_H */
+/* [] END OF FILE */
@@ -0,0 +1,123 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Per command cost of building the legacy UART_Cmd line for a 2 byte command:
+ *   sprintf    CmdBytes2String before V5.19, sprintf "%02X%02X", then the
+ *              9 pieces SendCmdString put one at a time copied into a line
+ *   table      EncodeCmdLine, hexChars into the prebuilt cmdLine
+ * UART_Cmd itself is left out, the old path also made 11 put calls a
+ * command where SendCmdLine makes 1. Every line is checked against the other.
+ * make cmd_size lists the code bytes of the encoders, on the target the old
+ * path also links newlib _vfprintf_r, the only formatted I/O in the build.
+ *
+ * Usage: cmd_bench [-n million commands]
+ *
+ * ========================================
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include <time.h>
+#include "daq.h"
+
+static uint8 benchLine[CMD_LINE_SIZE];
+static volatile uint32 benchSum;
+
+static inline uint64_t CmdCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief The line the way CmdBytes2String and SendCmdString built it before the table
+ */
+static void __attribute__((noinline)) CmdLineSprintf(const uint8 * in)
+{
+    char chars[COMMAND_CHARS + 1];
+    sprintf(chars, "%02X%02X", in[0], in[1]);
+    uint8 n = 0;
+    for (uint8 x = 0; x < 3; x++)
+    {
+        memcpy(&benchLine[n], START_COMMAND, START_COMMAND_SIZE);
+        n += START_COMMAND_SIZE;
+        memcpy(&benchLine[n], chars, COMMAND_CHARS);
+        n += COMMAND_CHARS;
+        memcpy(&benchLine[n], END_COMMAND, END_COMMAND_SIZE);
+        n += END_COMMAND_SIZE;
+    }
+    benchLine[n++] = CR;
+    benchLine[n] = LF;
+    benchSum += benchLine[1];
+}
+
+static void __attribute__((noinline)) CmdLineTable(const uint8 * in)
+{
+    EncodeCmdLine(in);
+    benchSum += cmdLine[1];
+}
+
+static void CmdRun(const char * name, void (*fn)(const uint8 *), uint32 cmds)
+{
+    uint8 cmd[2];
+    uint64_t c0 = CmdCycles();
+    for (uint32 i = 0; i < cmds; i++)
+    {
+        cmd[0] = i & 0xFF;
+        cmd[1] = (i >> 8) & 0xFF;
+        fn(cmd);
+    }
+    uint64_t c1 = CmdCycles();
+    printf("%-10s %8.2f cyc/cmd\n", name, (double)(c1 - c0) / cmds);
+}
+
+int main(int argc, char ** argv)
+{
+    uint32 millions = 4;
+    int opt;
+    while (-1 != (opt = getopt(argc, argv, "n:")))
+    {
+        switch (opt)
+        {
+            case 'n': millions = strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-n million commands]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (0 == millions) return 1;
+    for (uint32 i = 0; i < 0x10000; i++) //every command gives the same line both ways
+    {
+        uint8 cmd[2] = {i >> 8, i & 0xFF};
+        CmdLineSprintf(cmd);
+        CmdLineTable(cmd);
+        if (0 != memcmp(benchLine, cmdLine, CMD_LINE_SIZE))
+        {
+            fprintf(stderr, "lines differ for %02X%02X\n", cmd[0], cmd[1]);
+            return 1;
+        }
+    }
+    printf("%u million commands, %u byte line\n", millions, (unsigned)CMD_LINE_SIZE);
+    CmdRun("sprintf", CmdLineSprintf, millions * 1000000u);
+    CmdRun("table", CmdLineTable, millions * 1000000u);
+    return 0;
+}
+
+/* [] END OF FILE */
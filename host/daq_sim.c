@@ -0,0 +1,556 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Host simulation of the Main PSOC. Replays a recorded or synthesized Event
+ * PSOC byte stream into SPIS_Ev and runs the same startup and main loop as
+ * main.c against the simulated components in sim_hal.c.
+ *
+ * Usage: daq_sim [options] stream.bin
+ *   -r bytes/s  Event PSOC byte rate on SPIS_Ev (default 8000)
+ *   -l ns       virtual time taken by one main loop pass (default 20000)
+ *   -t sec      extra time to run after the stream ends (default 1)
+ *   -o file     write the UART_HR_Data output to file
+ *   -u file     write the USB output to file
+ *   -n          USB not connected
+ *   -q          skip the startup RTC and init command sequence
+ *   -s q,q,q,w  frame scheduler quantum of Event, backplane, HK and max wait
+ *               in frames, like command 0x42 (default 12,3,3,48)
+ *   -b us,defer main loop budget in us (of host cycles / 48) and passes in a row the low priority
+ *               tasks can be put off, like command 0x43 (default 1000,4)
+ *   -p us       queue a packet every us on the select line of each board polled (default none)
+ *   -d n        poll the first n boards of tabSPIDev, power board first, the others turned on with 0x4B (default 1)
+ *   -c          binary command frames on UART_Cmd from startup, like command 0x44 1
+ *   -g us[,n]   send a ground command packet of n commands (default 1, batched above 1)
+ *               for the Event PSOC on UART_LR_Cmd_1 every us, bytes at 9600 baud (default none)
+ *   -m          the ground command packets carry Main PSOC 0x41 busy threshold commands, 3 commands each
+ *   -k n        record n Event PSOC read errors commands then a 0x41 30,60 as command macro 0 on
+ *               UART_LR_Cmd_2 before the stream, save it, reload the slots as after a reset and run it with 0x60 as the stream starts
+ *
+ * ========================================
+*/
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <unistd.h>
+#include "daq.h"
+#include "sim_hal.h"
+
+#define SIM_BP_PACKET_BYTES (24u) //data bytes of a simulated backplane board packet
+#define SIM_GROUND_BYTE_NS SIM_UART_BYTE_NS(9600u) //UART_LR_Cmd_1 byte time
+
+static uint32 loopNs = 20000u;
+static uint64_t bpPeriodNs = 0; //spacing of the packets of each board, 0 sends none
+static uint8 bpBoards = 1; //boards of tabSPIDev polled and fed
+static const uint8 bpSimLine[NUM_SPI_DEV] = {SIM_BP_SEL2_PWR, SIM_BP_SEL3_J16, SIM_BP_SEL12_J17, SIM_BP_SEL13_J18, SIM_BP_SEL7_J20,
+                                             SIM_BP_SEL5_HV1, SIM_BP_SEL6_HV2}; //simulated select line of each tabSPIDev board
+static uint64_t bpNext = 0;
+static uint32 bpQueued = 0;
+static uint32 bpRejected = 0;
+static uint64_t groundPeriodNs = 0; //spacing of the ground commands, 0 sends none
+static uint64_t groundNext = 0; //time the next ground command starts
+static uint64_t groundByteNext = 0; //time the next byte of the ground command in progress arrives
+static uint16 groundPos = 0; //bytes of the ground command packet in progress sent
+static uint32 groundCmds = 0;
+static uint32 groundBytes = 0;
+static uint32 groundLost = 0; //bytes that found the UART_LR_Cmd_1 RX FIFO full
+static uint8 groundRxPeak = 0; //most bytes waiting in a buffLRCmdRx ring at the start of a pass
+static uint8 groundPacket[3 + 254 + 2]; //DLE CMD_ID len, the commands, checksum of a batch and ETX
+static uint16 groundPacketLen = 0;
+static uint8 groundPacketCmds = 0;
+static uint8 groundMain = FALSE; //ground packets of Main PSOC commands in place of Event PSOC ones
+static uint32 interpretBehind = 0; //passes that ended with commands InterpretCmdBuffers had not got to
+static uint16 interpretBacklogPeak = 0; //most commands InterpretCmdBuffers had not got to at the end of a pass
+static uint8 macroCmds = 0; //Event PSOC commands in command macro 0, 0 records none
+static uint64_t macroSaveNs = 0; //time from 0x56 until the macro was in its EEPROM slot
+static uint8 macroReloaded = FALSE; //slot 0 read back from the EEPROM by InitCmdMacros as it was saved
+
+/**
+ * @brief Builds the ground command packet of n Event PSOC read errors commands, data byte then address byte
+ * @details With groundMain n is rounded down to whole 0x41 commands of 3, thresholds 20 and 80 %
+ */
+static void BuildGroundPacket(uint8 n)
+{
+    static const uint8 busyThres[3][2] = {{0x41, CMD_MAIN_BYTE_ADDRESS(2)}, {20, CMD_MAIN_BYTE_ADDRESS(1)}, {80, CMD_MAIN_BYTE_ADDRESS(2)}};
+    uint16 len = 0;
+    if (TRUE == groundMain) n = MAX(n / 3, 1) * 3;
+    uint8 sum = 2 * n;
+    groundPacket[len++] = DLE;
+    groundPacket[len++] = CMD_ID;
+    groundPacket[len++] = 2 * n;
+    for (uint8 x = 0; x < n; x++)
+    {
+        uint8 data = (TRUE == groundMain) ? busyThres[x % 3][0] : 0x03;
+        uint8 adr = (TRUE == groundMain) ? busyThres[x % 3][1] : 0x20;
+        groundPacket[len++] = data;
+        groundPacket[len++] = adr;
+        sum += data + adr;
+    }
+    if (1 < n) groundPacket[len++] = -sum;
+    groundPacket[len++] = ETX;
+    groundPacketLen = len;
+    groundPacketCmds = n;
+}
+static uint64_t initCmdNs = 0; //time SendInitCmds queued the init commands
+static uint64_t initDrainNs = 0; //time from SendInitCmds until UART_Cmd took the last of them, 0 until then
+static uint64_t initCmdBytes = 0; //UART_Cmd bytes out when SendInitCmds queued them
+static uint64_t initIdleNs = 0; //UART_Cmd wire idle while the init commands drained
+static const char * const traceStageName[TRACE_STAGES] = {"ISRReadEv", "ISRReadSPI", "CheckEventPackets", "CheckFrameBuffer", "CheckHKBuffer", "CheckI2C", "main loop"};
+
+/**
+ * @brief Queues the packets due by now on the select line of each board polled, 24 data bytes kept under 0x80
+ */
+static void FeedBackplane(void)
+{
+    while ((0 != bpPeriodNs) && (bpNext <= simTimeNs))
+    {
+        for (uint8 dev = 0; dev < bpBoards; dev++)
+        {
+            uint8 pkt[SIM_BP_PACKET_BYTES];
+            for (uint8 i = 0; i < SIM_BP_PACKET_BYTES; i++) pkt[i] = (bpQueued + i) & 0x7F;
+            if (0 < SimBPQueue(bpSimLine[dev], pkt, sizeof(pkt))) bpQueued++;
+            else bpRejected++;
+        }
+        bpNext += bpPeriodNs;
+    }
+}
+
+/**
+ * @brief Sends the ground command bytes due by now into UART_LR_Cmd_1 one byte time apart
+ */
+static void FeedGround(void)
+{
+    while (0 != groundPeriodNs)
+    {
+        if (0 == groundPos)
+        {
+            if (groundNext > simTimeNs) return;
+            groundByteNext = groundNext;
+            groundNext = MAX(groundNext + groundPeriodNs, groundNext + (groundPacketLen * SIM_GROUND_BYTE_NS)); //back to back at most
+            groundCmds += groundPacketCmds;
+        }
+        if (groundByteNext > simTimeNs) return;
+        if (0 == SimLRCmdPush(0, &groundPacket[groundPos], 1)) groundLost++;
+        groundBytes++;
+        groundByteNext += SIM_GROUND_BYTE_NS;
+        groundPos = (groundPos + 1) % groundPacketLen;
+    }
+}
+
+/**
+ * @brief Counts the backplane packets framed in an output capture by their header
+ */
+static uint32 CountBackplanePackets(const SimSink * sink)
+{
+    uint32 n = 0;
+    uint8 last[2] = {0, 0};
+    for (uint32 i = 0; i < sink->captureLen; i++)
+    {
+        uint32 off = i % sizeof(FrameOutput);
+        if (offsetof(FrameOutput, data) > off) continue; //seq and sync
+        uint8 b = sink->capture[i];
+        if ((frame00FF[0] == last[1]) && (frame00FF[1] == b))
+        {
+            for (uint8 dev = 0; dev < bpBoards; dev++)
+            {
+                if (tabSPIDev[dev].head == last[0])
+                {
+                    n++;
+                    break;
+                }
+            }
+        }
+        last[0] = last[1];
+        last[1] = b;
+    }
+    return n;
+}
+
+/**
+ * @brief Notes the time the init commands are all handed to UART_Cmd, and out of buffCmdTx unless ground commands follow on source 0
+ */
+static void CheckInitDrain(void)
+{
+    if ((0 != initCmdNs) && (0 == initDrainNs) && (NUMBER_INIT_CMDS <= initCmdPos) && ((buffCmdTxRead == buffCmdTxWrite) || (readBuffCmd[0] != writeBuffCmd[0])))
+    {
+        initDrainNs = simTimeNs - initCmdNs;
+        uint64_t busyNs = (simSinkCmd.bytes - initCmdBytes) * simTiming.cmdByteNs;
+        initIdleNs = (initDrainNs > busyNs) ? (initDrainNs - busyNs) : 0;
+    }
+}
+
+/**
+ * @brief Counts the commands InterpretCmdBuffers left for the next pass
+ * @details Only those queued before the pass count, with LOOP_SLEEP the pass can end in a WFI that took more.
+ */
+static void CheckInterpretBacklog(const uint8 * passHeader, const uint8 * passWrite)
+{
+    uint16 backlog = 0;
+    for (uint8 i = 0; i < COMMAND_SOURCES; i++)
+    {
+        uint8 pending = RING_LEN(passHeader[i], passWrite[i], CMD_BUFFER_SIZE);
+        uint8 done = RING_LEN(passHeader[i], headerBuffCmd[i], CMD_BUFFER_SIZE);
+        backlog += (pending > done) ? (pending - done) : 0;
+    }
+    if (0 != backlog) interpretBehind++;
+    interpretBacklogPeak = MAX(interpretBacklogPeak, backlog);
+}
+
+/**
+ * @brief One main loop pass with the checks of the simulation around it
+ */
+static void RunPass(void)
+{
+    uint8 passHeader[COMMAND_SOURCES];
+    uint8 passWrite[COMMAND_SOURCES];
+    memcpy(passHeader, headerBuffCmd, COMMAND_SOURCES);
+    memcpy(passWrite, (const uint8 *)writeBuffCmd, COMMAND_SOURCES);
+    FeedBackplane();
+    FeedGround();
+    for (uint8 i = 0; i < LR_CMD_PORTS; i++)
+    {
+        groundRxPeak = MAX(groundRxPeak, RING_LEN(buffLRCmdRxRead[i], buffLRCmdRxWrite[i], LR_CMD_RX_SIZE));
+    }
+    MainLoopPass();
+    CheckInitDrain();
+    CheckInterpretBacklog(passHeader, passWrite);
+}
+
+/**
+ * @brief Runs the main loop passes for a period of virtual time
+ * @param ns time to run
+ */
+static void RunLoops(uint64_t ns)
+{
+    uint64_t end = simTimeNs + ns;
+    while (simTimeNs < end)
+    {
+        RunPass();
+        SimAdvance(loopNs);
+    }
+}
+
+/**
+ * @brief Parses up to 127 commands as a ground command packet of source 1
+ */
+static void SendMainCmds(const uint8 (*cmds)[2], uint8 n)
+{
+    uint8 sum = 2 * n;
+    ParseCmdInputByte(DLE, 1);
+    ParseCmdInputByte(CMD_ID, 1);
+    ParseCmdInputByte(2 * n, 1);
+    for (uint8 x = 0; x < n; x++)
+    {
+        ParseCmdInputByte(cmds[x][0], 1);
+        ParseCmdInputByte(cmds[x][1], 1);
+        sum += cmds[x][0] + cmds[x][1];
+    }
+    if (1 < n) ParseCmdInputByte(-sum, 1);
+    ParseCmdInputByte(ETX, 1);
+}
+
+/**
+ * @brief Turns on polling of the boards of tabSPIDev after the power board up to bpBoards with command 0x4B
+ */
+static void ScheduleBackplane(void)
+{
+    uint8 cmds[4 * NUM_SPI_DEV][2];
+    uint8 n = 0;
+    for (uint8 dev = 1; dev < bpBoards; dev++)
+    {
+        cmds[n][0] = 0x4B;
+        cmds[n++][1] = CMD_MAIN_BYTE_ADDRESS(3);
+        cmds[n][0] = dev;
+        cmds[n++][1] = CMD_MAIN_BYTE_ADDRESS(1);
+        cmds[n][0] = BP_POLL_US >> 8;
+        cmds[n++][1] = CMD_MAIN_BYTE_ADDRESS(2);
+        cmds[n][0] = BP_POLL_US & 0xFF;
+        cmds[n++][1] = CMD_MAIN_BYTE_ADDRESS(3);
+    }
+    if (0 == n) return;
+    SendMainCmds(cmds, n);
+    while (headerBuffCmd[1] != writeBuffCmd[1]) RunLoops(loopNs); //0x4B interpreted
+}
+
+/**
+ * @brief Records macroCmds Event PSOC read errors commands and a 0x41 30,60 as command macro 0 and waits for the EEPROM save, then reloads the slots as after a reset
+ */
+static void RecordMacro(void)
+{
+    uint8 cmds[127][2];
+    uint8 body[CMD_MACRO_CMDS][2];
+    uint8 m = 0;
+    uint8 n = 0;
+    uint64_t tmpGround = groundPeriodNs;
+    uint64_t tmpBP = bpPeriodNs;
+    groundPeriodNs = bpPeriodNs = 0; //nothing fed before the stream
+    for (; m < macroCmds; m++)
+    {
+        body[m][0] = 0x03;
+        body[m][1] = 0x20;
+    }
+    const uint8 busyThres[3][2] = {{0x41, CMD_MAIN_BYTE_ADDRESS(2)}, {30, CMD_MAIN_BYTE_ADDRESS(1)}, {60, CMD_MAIN_BYTE_ADDRESS(2)}};
+    memcpy(body[m], busyThres, sizeof(busyThres));
+    m += 3;
+    cmds[n][0] = 0x54; //begin slot 0
+    cmds[n++][1] = CMD_MAIN_BYTE_ADDRESS(1);
+    cmds[n][0] = 0;
+    cmds[n++][1] = CMD_MAIN_BYTE_ADDRESS(1);
+    for (uint8 x = 0; x < m; x += 7) //append 7 commands, 14 data-byte commands, at a time
+    {
+        uint8 k = MIN(m - x, 7) * 2;
+        if (127 < (n + 1 + k)) //whole Main PSOC commands in a packet
+        {
+            SendMainCmds(cmds, n);
+            while (readBuffCmd[1] != writeBuffCmd[1]) RunLoops(loopNs); //UART_Cmd sends them too, the next packet would not fit
+            n = 0;
+        }
+        cmds[n][0] = 0x55;
+        cmds[n++][1] = CMD_MAIN_BYTE_ADDRESS(k);
+        for (uint8 d = 1; d <= k; d++)
+        {
+            cmds[n][0] = body[x + ((d - 1) / 2)][(d - 1) & 1];
+            cmds[n++][1] = CMD_MAIN_BYTE_ADDRESS(d);
+        }
+    }
+    cmds[n][0] = 0x56; //save
+    cmds[n++][1] = CMD_MAIN_PSOC_ADDRESS;
+    SendMainCmds(cmds, n);
+    while (headerBuffCmd[1] != writeBuffCmd[1]) RunLoops(loopNs); //0x56 interpreted
+    uint64_t start = simTimeNs;
+    while ((CMD_MACROS > cmdMacroSaveSlot) || (0 != cmdMacroSavePending)) RunLoops(loopNs);
+    macroSaveNs = simTimeNs - start;
+    InitCmdMacros(); //as after a reset
+    macroReloaded = (0 == memcmp(&cmdMacro[0], &cmdMacroEdit, 2 + (2 * cmdMacroEdit.numCmds))) ? TRUE : FALSE;
+    groundPeriodNs = tmpGround;
+    bpPeriodNs = tmpBP;
+}
+
+/**
+ * @brief Startup sequence of main() after the components are started
+ */
+static void Startup(uint8 quick)
+{
+    InitBuffers();
+    InitRTC();
+    InitFrameBuffer(); //intialize sync and seq num
+    InitHKBuffer();
+    InitTrace();
+    InitLRScienceData();
+    InitCmdMacros();
+    InitFrameDMA(); //keep this high rate channel for UART
+    if (quick) return;
+
+    I2C_RTC_MasterClearStatus();
+    rtcStatus = RTS_SET_MAIN;
+    CyDelay(3000); // delay for boards to init
+    do  //get set RTC Main
+    {
+        CheckRTC();
+        CheckI2C();
+        SimAdvance(loopNs);
+    }while(0 != rtcStatus);
+    rtcStatus = RTS_SET_EVENT;
+    do  //get set RTC Event
+    {
+        CheckRTC();
+        CheckCmdBuffers();
+        SimAdvance(loopNs);
+    }while(0 != rtcStatus);
+    while(readBuffCmd[0] != writeBuffCmd[0]) //Finish all commands
+    {
+        CheckCmdBuffers();
+        SimAdvance(loopNs);
+    }
+    SendInitCmds();//Enqueued all init commands
+    initCmdNs = simTimeNs;
+    initCmdBytes = simSinkCmd.bytes;
+    InitBaroI2COTP();
+}
+
+/**
+ * @brief Counts the frames in an output capture and checks sync and sequence
+ * @return uint32 number of frames with a bad sync or out of sequence
+ */
+static uint32 CheckFrames(const SimSink * sink, uint32 * nFrames)
+{
+    uint32 bad = 0;
+    uint32 lastSeq = 0;
+    *nFrames = sink->captureLen / sizeof(FrameOutput);
+    for (uint32 i = 0; i < *nFrames; i++)
+    {
+        const uint8 * f = sink->capture + (i * sizeof(FrameOutput));
+        uint32 seq = ((uint32)f[0] << 16) | ((uint32)f[1] << 8) | f[2];
+        if ((frameSync[0] != f[3]) || (frameSync[1] != f[4]) || (frameSync[0] != f[5]) || (frameSync[1] != f[6]))
+        {
+            bad++;
+        }
+        else if ((0 < i) && (((lastSeq + 1) & 0xFFFFFF) != seq))
+        {
+            bad++;
+        }
+        lastSeq = seq;
+    }
+    return bad;
+}
+
+int main(int argc, char ** argv)
+{
+    uint32 evRate = 8000u;
+    uint32 tailSecs = 1;
+    uint8 quick = FALSE;
+    unsigned sched[FRAME_SOURCES + 1];
+    int opt;
+    while (-1 != (opt = getopt(argc, argv, "r:l:t:o:u:nqs:b:p:d:cg:mk:")))
+    {
+        switch (opt)
+        {
+            case 'r': evRate = strtoul(optarg, NULL, 0); break;
+            case 'l': loopNs = strtoul(optarg, NULL, 0); break;
+            case 't': tailSecs = strtoul(optarg, NULL, 0); break;
+            case 'o': simSinkHR.file = fopen(optarg, "wb"); break;
+            case 'u': simSinkUSB.file = fopen(optarg, "wb"); break;
+            case 'n': simUsbConnected = FALSE; break;
+            case 'q': quick = TRUE; break;
+            case 's':
+                if (4 != sscanf(optarg, "%u,%u,%u,%u", &sched[0], &sched[1], &sched[2], &sched[3])) return 1;
+                for (uint8 i = 0; i < FRAME_SOURCES; i++) frameSchedQuantum[i] = MAX(MIN(sched[i], 255), 1);
+                frameSchedMaxWait = MIN(sched[FRAME_SOURCES], 255);
+                break;
+            case 'p': bpPeriodNs = 1000ull * strtoul(optarg, NULL, 0); break;
+            case 'g':
+                sched[1] = 1;
+                if (1 > sscanf(optarg, "%u,%u", &sched[0], &sched[1])) return 1;
+                groundPeriodNs = 1000ull * MAX(sched[0], 1);
+                groundPacketCmds = MAX(MIN(sched[1], 127), 1);
+                break;
+            case 'm': groundMain = TRUE; break;
+            case 'k': macroCmds = MIN(strtoul(optarg, NULL, 0), CMD_MACRO_CMDS - 3); break;
+            case 'c': SetCmdLinkFormat(CMD_LINK_BINARY); break;
+            case 'd': bpBoards = MAX(MIN(strtoul(optarg, NULL, 0), NUM_SPI_DEV), 1); break;
+            case 'b':
+                if (2 != sscanf(optarg, "%u,%u", &sched[0], &sched[1])) return 1;
+                SetLoopBudget(MIN(sched[0], 65535), MIN(sched[1], 255));
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-r bytes/s] [-l loop ns] [-t secs] [-o hr.bin] [-u usb.bin] [-n] [-q] [-s q,q,q,w] [-b us,defer] [-p us] [-d boards] [-c] [-g us[,n]] [-m] [-k n] stream.bin\n", argv[0]);
+                return 1;
+        }
+    }
+    if ((optind >= argc) || (0 == evRate) || (0 == loopNs))
+    {
+        fprintf(stderr, "usage: %s [-r bytes/s] [-l loop ns] [-t secs] [-o hr.bin] [-u usb.bin] [-n] [-q] [-s q,q,q,w] [-b us,defer] [-p us] [-d boards] [-c] [-g us[,n]] [-m] [-k n] stream.bin\n", argv[0]);
+        return 1;
+    }
+    FILE * in = fopen(argv[optind], "rb");
+    if (NULL == in)
+    {
+        perror(argv[optind]);
+        return 1;
+    }
+    fseek(in, 0, SEEK_END);
+    long len = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    uint8 * stream = malloc((len > 0) ? len : 1);
+    if ((0 > len) || ((size_t)len != fread(stream, 1, len, in)))
+    {
+        perror(argv[optind]);
+        return 1;
+    }
+    fclose(in);
+
+    if (0 != groundPeriodNs) BuildGroundPacket(groundPacketCmds);
+    simTiming.evByteNs = (uint32)(SIM_NS_PER_SEC / evRate);
+    SimInit();
+    Startup(quick);
+    InitBackplane(); //backplane readout runs from SysTick from here on
+    ScheduleBackplane();
+    if (0 != macroCmds) RecordMacro();
+
+    SimSinkReset(&simSinkHR);
+    SimSinkReset(&simSinkUSB);
+    simSinkHR.keepCapture = TRUE;
+    simSinkUSB.keepCapture = TRUE;
+    uint16 startDropped = cntFramesDropped;
+    uint16 startDroppedUSB = cntFramesDroppedUSB;
+    uint64_t startNs = simTimeNs;
+    uint64_t startEvIn = simStats.evBytesIn;
+    uint64_t startEvLost = simStats.evOverruns;
+    uint64_t startSleeps = simStats.sleeps;
+    uint64_t startSleepNs = simStats.sleepNs;
+
+    SimEvSetSource(stream, (uint32)len);
+    bpNext = simTimeNs;
+    groundNext = simTimeNs;
+    uint16 startCmd = cntCmd;
+    uint64_t startIsrCmd = simStats.isrCalls[SIM_ISR_CMD];
+    if (0 != macroCmds)
+    {
+        const uint8 runMacro[1][2] = {{CMD_MACRO_RUN_ID, CMD_MAIN_PSOC_ADDRESS}};
+        SendMainCmds(runMacro, 1);
+    }
+    while (0 < SimEvSourceLeft())
+    {
+        RunPass();
+        SimAdvance(loopNs);
+    }
+    RunLoops((uint64_t)tailSecs * SIM_NS_PER_SEC);
+
+    uint32 nFrames, nFramesUSB;
+    uint32 badFrames = CheckFrames(&simSinkHR, &nFrames);
+    uint32 badFramesUSB = CheckFrames(&simSinkUSB, &nFramesUSB);
+    printf("stream bytes        %ld\n", len);
+    printf("virtual time        %.3f s\n", (double)(simTimeNs - startNs) / SIM_NS_PER_SEC);
+    printf("SPIS_Ev bytes in    %llu\n", (unsigned long long)(simStats.evBytesIn - startEvIn));
+    printf("SPIS_Ev overruns    %llu\n", (unsigned long long)(simStats.evOverruns - startEvLost));
+    printf("HR frames out       %u (%u bad sync or seq)\n", nFrames, badFrames);
+    printf("USB frames out      %u (%u bad sync or seq, %llu packets)\n", nFramesUSB, badFramesUSB, (unsigned long long)simSinkUSB.packets);
+    printf("frames dropped      HR %u USB %u\n", (uint16)(cntFramesDropped - startDropped), (uint16)(cntFramesDroppedUSB - startDroppedUSB));
+    printf("frame wait peak     Event %u backplane %u HK %u frames, bound %u\n", frameSchedWaitPeak[FRAME_SRC_EVENT], frameSchedWaitPeak[FRAME_SRC_BP], frameSchedWaitPeak[FRAME_SRC_HK], frameSchedMaxWait);
+    printf("diagnostic packets  %u, trace since the last one in host cycles:\n", buffDiag.sequence);
+    for (uint8 i = 0; i < TRACE_STAGES; i++)
+    {
+        printf("  %-17s calls %8u last %8u peak %8u\n", traceStageName[i], traceTiming[i].calls, traceTiming[i].last, traceTiming[i].peak);
+    }
+    printf("loop time log2      ");
+    for (uint8 i = 0; i < LOOP_HIST_BUCKETS; i++)
+    {
+        printf(" %u", loopHist[i]);
+    }
+    printf(", %u passes put off the low priority tasks\n", cntLoopYields);
+    printf("main loop sleep     %.1f%% of the time in %llu WFI\n", 100.0 * (simStats.sleepNs - startSleepNs) / (simTimeNs - startNs),
+           (unsigned long long)(simStats.sleeps - startSleeps));
+    printf("occupancy peak      buffEv %u packetEv %u buffSPI %u buffCmd %u buffI2C %u\n", tracePeak[TRACE_PEAK_EV], tracePeak[TRACE_PEAK_PACKET_EV],
+           tracePeak[TRACE_PEAK_SPI], tracePeak[TRACE_PEAK_CMD], tracePeak[TRACE_PEAK_I2C]);
+    printf("backplane packets   %u queued on %u boards (%u board full), %u framed on USB\n", bpQueued, bpBoards, bpRejected, CountBackplanePackets(&simSinkUSB));
+    printf("backplane ISRs      ISRReadSPI %llu ISRWriteSPI %llu ISRTickBP %llu\n", (unsigned long long)simStats.isrCalls[SIM_ISR_SPI_RX],
+           (unsigned long long)simStats.isrCalls[SIM_ISR_SEL_LOW], (unsigned long long)simStats.isrCalls[SIM_ISR_TICK]);
+    printf("commands to Event   %llu bytes, init commands out %.1f ms after queued (%.1f ms idle)\n", (unsigned long long)simSinkCmd.bytes,
+           (double)initDrainNs / 1e6, (double)initIdleNs / 1e6);
+    printf("ground commands     %u sent in %u bytes, %u queued, %u bytes lost, %llu isr_Cm calls\n", groundCmds, groundBytes, (uint16)(cntCmd - startCmd), groundLost,
+           (unsigned long long)(simStats.isrCalls[SIM_ISR_CMD] - startIsrCmd));
+    printf("ground command rx   buffLRCmdRx peak %u of %u bytes, %u bytes lost on a full ring\n", groundRxPeak, LR_CMD_RX_SIZE - 1u,
+           cntLRCmdRxLost[0] + cntLRCmdRxLost[1]);
+    printf("command interpreter %u passes left commands for the next, peak %u commands, busy thresholds %u %u\n", interpretBehind, interpretBacklogPeak,
+           outputBusyLowThres, outputBusyHighThres);
+    if (0 != macroCmds)
+    {
+        printf("command macro 0     %u commands, saved in %.1f ms (%u EEPROM rows), %s after a reset, run %s at %u\n", cmdMacroEdit.numCmds,
+               (double)macroSaveNs / 1e6, simEEPROMRows, (TRUE == macroReloaded) ? "reloaded" : "lost", (CMD_MACROS > cmdMacroRunSlot) ? "stuck" : "queued up",
+               cmdMacroRunPos);
+    }
+    printf("errors              general %u command %u\n", cntError, cntCmdError);
+    if (NULL != simSinkHR.file) fclose(simSinkHR.file);
+    if (NULL != simSinkUSB.file) fclose(simSinkUSB.file);
+    free(stream);
+    return 0;
+}
+
+/* [] END OF FILE */
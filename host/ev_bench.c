@@ -0,0 +1,293 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Event stream replay benchmark. Feeds a synthesized or recorded Event PSOC
+ * stream through SPIS_Ev and ISRReadEv into buffEv, then CheckEventPackets and
+ * CheckFrameBuffer once a main loop pass, while the simulated UART_HR_Data and
+ * USB drain the frames in virtual time.
+ *
+ * Reported per stream:
+ *   events    packets in the stream, framed is how many CheckEventPackets queued
+ *             as an event (header DB/DC ... EOR), dumps are the other queued blocks
+ *   ev/s B/s  throughput of the firmware code alone, host time spent in the 3 calls
+ *   cyc       host cycles per call, average and max, CheckFrameBuffer per frame
+ *             emitted, and total per input byte
+ *   dropped   cntFramesDropped / cntFramesDroppedUSB at the offered rate, and the
+ *             Event bytes ISRReadEv dropped with buffEv full
+ *
+ * Usage: ev_bench [options]
+ *   -t type     fix, var, hk, mix or garbage (default all of them)
+ *   -e events   packets to synthesize (default 5000)
+ *   -f file     replay a recorded stream instead
+ *   -w file     write the synthesized stream to file and exit
+ *   -r bytes/s  offered Event PSOC rate in virtual time (default 8000)
+ *   -l ns       virtual time of one main loop pass (default 20000)
+ *   -s seed     seed of the synthesized stream (default 1)
+ *   -n          USB not connected
+ *
+ * ========================================
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "daq.h"
+#include "sim_hal.h"
+#include "ev_stream.h"
+
+#define BENCH_TAIL_PASSES (20000u) //passes after the stream ends to drain buffEv and the frames
+
+typedef struct BenchCall {
+    uint64_t calls;
+    uint64_t cycles;
+    uint64_t max;
+} BenchCall;
+
+typedef struct BenchResult {
+    uint32 bytes;
+    uint32 events;
+    uint32 framed;
+    uint32 dumps;
+    uint32 dumpBytes;
+    BenchCall isr;
+    BenchCall check;
+    BenchCall frame;
+    uint16 dropped;
+    uint16 droppedUSB;
+    uint32 overruns;
+    uint16 evDropped;
+    uint32 frames;
+} BenchResult;
+
+static uint32 evRate = 8000u;
+static uint32 loopNs = 20000u;
+
+static inline uint64_t BenchCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * SIM_NS_PER_SEC) + ts.tv_nsec;
+#endif
+}
+
+static double BenchCyclesPerSec(void)
+{
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    uint64_t c0 = BenchCycles();
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+    } while (((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) < 50e6);
+    uint64_t c1 = BenchCycles();
+    return (double)(c1 - c0) / (((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / 1e9);
+}
+
+static inline void BenchAdd(BenchCall * c, uint64_t cycles)
+{
+    c->calls++;
+    c->cycles += cycles;
+    if (cycles > c->max) c->max = cycles;
+}
+
+/**
+ * @brief Sorts the packets CheckEventPackets queued since lastTail into events and dumps
+ */
+static void BenchClassify(BenchResult * res, uint8 lastTail)
+{
+    while (lastTail != packetEvTail)
+    {
+        PacketEvent * p = &packetEv[lastTail];
+        uint8 head = buffEv[p->header];
+        uint32 len = RING_LEN(p->header, p->EOR, EV_BUFFER_SIZE) + 1;
+        if (((EVFIX_HEAD == head) || (EVVAR_HEAD == head)) && (EOR_HEAD == buffEv[RING_WRAP(p->EOR + EV_BUFFER_SIZE - 2, EV_BUFFER_SIZE)]) && (EV_MAX_SIZE + 2 >= len))
+        {
+            res->framed++;
+        }
+        else
+        {
+            res->dumps++;
+            res->dumpBytes += len;
+        }
+        lastTail = RING_INC(lastTail, PACKET_EVENT_SIZE);
+    }
+}
+
+/**
+ * @brief Runs one stream through the Event path, in a fresh process so all the firmware state starts clean
+ */
+static void BenchRun(const uint8 * stream, uint32 len, uint32 events, BenchResult * res)
+{
+    memset(res, 0, sizeof(BenchResult));
+    res->bytes = len;
+    res->events = events;
+    SimInit();
+    InitBuffers();
+    InitFrameBuffer();
+    InitHKBuffer();
+    InitTrace();
+    InitLRScienceData();
+    InitCmdMacros();
+    InitFrameDMA();
+    InitBackplane();
+
+    uint64_t credit = 0; //bytes owed at the offered rate, in units of 1/1e9 byte
+    uint32 pos = 0;
+    uint32 tail = 0;
+    while (BENCH_TAIL_PASSES > tail)
+    {
+        credit += (uint64_t)evRate * loopNs;
+        while ((pos < len) && (SIM_NS_PER_SEC <= credit))
+        {
+            uint32 n = MIN(SIM_SPIS_EV_FIFO_SIZE, len - pos);
+            n = MIN(n, credit / SIM_NS_PER_SEC);
+            res->overruns += n - SimEvPush(stream + pos, n);
+            pos += n;
+            credit -= (uint64_t)n * SIM_NS_PER_SEC;
+            uint64_t c0 = BenchCycles();
+            ISRReadEv();
+            BenchAdd(&res->isr, BenchCycles() - c0);
+        }
+        if (pos >= len)
+        {
+            credit = 0;
+            tail++;
+        }
+        uint8 lastTail = packetEvTail;
+        uint64_t c0 = BenchCycles();
+        CheckEventPackets();
+        uint64_t c1 = BenchCycles();
+        CheckFrameBuffer();
+        uint64_t c2 = BenchCycles();
+        BenchAdd(&res->check, c1 - c0);
+        BenchAdd(&res->frame, c2 - c1);
+        BenchClassify(res, lastTail);
+        SimAdvance(loopNs);
+    }
+    res->dropped = cntFramesDropped;
+    res->droppedUSB = cntFramesDroppedUSB;
+    res->evDropped = cntEvDropped;
+    res->frames = ((uint32)seqFrame2HB << 8) | (buffFrameDataWrite & 0xFF); //frame seq counts every frame FrameAppend / FrameFlush emitted
+}
+
+static void BenchPrintHeader(void)
+{
+    printf("%-8s %8s %7s %7s %6s %9s %9s %9s | %-14s %-14s %-14s %7s %7s | %7s %7s\n",
+        "stream", "bytes", "events", "framed", "dumps", "dumpB", "ev/s", "B/s",
+        "ISRReadEv", "CheckEvPkts", "CheckFrame", "cyc/frm", "cyc/B", "dropHR", "dropUSB");
+}
+
+static void BenchPrint(const char * name, const BenchResult * res, double cps)
+{
+    uint64_t total = res->isr.cycles + res->check.cycles + res->frame.cycles;
+    double secs = total / cps;
+    char isr[32], check[32], frame[32];
+    snprintf(isr, sizeof(isr), "%llu/%llu", (unsigned long long)(res->isr.calls ? res->isr.cycles / res->isr.calls : 0), (unsigned long long)res->isr.max);
+    snprintf(check, sizeof(check), "%llu/%llu", (unsigned long long)(res->check.calls ? res->check.cycles / res->check.calls : 0), (unsigned long long)res->check.max);
+    snprintf(frame, sizeof(frame), "%llu/%llu", (unsigned long long)(res->frame.calls ? res->frame.cycles / res->frame.calls : 0), (unsigned long long)res->frame.max);
+    printf("%-8s %8u %7u %7u %6u %9u %9.0f %9.0f | %-14s %-14s %-14s %7.1f %7.1f | %7u %7u\n",
+        name, res->bytes, res->events, res->framed, res->dumps, res->dumpBytes,
+        res->framed / secs, res->bytes / secs, isr, check, frame,
+        res->frames ? (double)res->frame.cycles / res->frames : 0.0,
+        res->bytes ? (double)total / res->bytes : 0.0, res->dropped, res->droppedUSB);
+    if (res->overruns) printf("%-8s SPIS_Ev overruns %u\n", "", res->overruns);
+    if (res->evDropped) printf("%-8s buffEv full, dropped %u bytes\n", "", res->evDropped);
+}
+
+static int BenchOne(const char * name, const uint8 * stream, uint32 len, uint32 events, double cps)
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if (0 == pid)
+    {
+        BenchResult res;
+        BenchRun(stream, len, events, &res);
+        BenchPrint(name, &res, cps);
+        fflush(stdout);
+        _exit(0);
+    }
+    int status = 1;
+    if ((0 > pid) || (pid != waitpid(pid, &status, 0))) return -1;
+    return status;
+}
+
+int main(int argc, char ** argv)
+{
+    int type = -1;
+    uint32 events = 5000;
+    uint32 seed = 1;
+    const char * inFile = NULL;
+    const char * outFile = NULL;
+    int opt;
+    while (-1 != (opt = getopt(argc, argv, "t:e:f:w:r:l:s:n")))
+    {
+        switch (opt)
+        {
+            case 't': type = EvStreamType(optarg); if (0 > type) { fprintf(stderr, "unknown stream %s\n", optarg); return 1; } break;
+            case 'e': events = strtoul(optarg, NULL, 0); break;
+            case 'f': inFile = optarg; break;
+            case 'w': outFile = optarg; break;
+            case 'r': evRate = strtoul(optarg, NULL, 0); break;
+            case 'l': loopNs = strtoul(optarg, NULL, 0); break;
+            case 's': seed = strtoul(optarg, NULL, 0); break;
+            case 'n': simUsbConnected = FALSE; break;
+            default:
+                fprintf(stderr, "usage: %s [-t fix|var|hk|mix|garbage] [-e events] [-f stream.bin] [-w out.bin] [-r bytes/s] [-l loop ns] [-s seed] [-n]\n", argv[0]);
+                return 1;
+        }
+    }
+    if ((0 == evRate) || (0 == loopNs)) return 1;
+    uint32 cap = (events + 1) * (EV_STREAM_MAX_PACKET + 48);
+    uint8 * stream = malloc(cap);
+    double cps = BenchCyclesPerSec();
+    printf("offered %u B/s, main loop pass %u ns, HR %u ns/B, %.0f host cycles/s\n", evRate, loopNs, SIM_UART_BYTE_NS(115200u), cps);
+
+    if (NULL != inFile)
+    {
+        FILE * in = fopen(inFile, "rb");
+        if (NULL == in) { perror(inFile); return 1; }
+        free(stream);
+        fseek(in, 0, SEEK_END);
+        long len = ftell(in);
+        fseek(in, 0, SEEK_SET);
+        stream = malloc((0 < len) ? len : 1);
+        if ((0 > len) || ((size_t)len != fread(stream, 1, len, in))) { perror(inFile); return 1; }
+        fclose(in);
+        BenchPrintHeader();
+        return BenchOne(inFile, stream, (uint32)len, 0, cps);
+    }
+    if (NULL != outFile)
+    {
+        uint32 len = EvStreamMake(stream, cap, (0 > type) ? EV_STREAM_MIX : type, events, seed);
+        FILE * out = fopen(outFile, "wb");
+        if ((NULL == out) || (len != fwrite(stream, 1, len, out))) { perror(outFile); return 1; }
+        fclose(out);
+        return 0;
+    }
+    BenchPrintHeader();
+    for (int t = 0; t < EV_STREAM_TYPES; t++)
+    {
+        if ((0 <= type) && (t != type)) continue;
+        uint32 len = EvStreamMake(stream, cap, t, events, seed);
+        if (0 != BenchOne(evStreamName[t], stream, len, events, cps)) return 1;
+    }
+    free(stream);
+    return 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,116 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ * ========================================
+*/
+
+#include <string.h>
+#include "daq.h"
+#include "ev_stream.h"
+
+const char * const evStreamName[EV_STREAM_TYPES] = {"fix", "var", "hk", "mix", "garbage"};
+
+static uint32 evStreamRand;
+
+static uint32 EvRand(void) //xorshift32, repeatable across hosts
+{
+    evStreamRand ^= evStreamRand << 13;
+    evStreamRand ^= evStreamRand >> 17;
+    evStreamRand ^= evStreamRand << 5;
+    return evStreamRand;
+}
+
+static uint32 EvPacketFix(uint8 * out)
+{
+    uint32 n = 0;
+    out[n++] = EVFIX_HEAD;
+    out[n++] = frame00FF[0];
+    out[n++] = frame00FF[1];
+    for (uint8 i = 0; i < 3; i++) out[n++] = (uint8)EvRand();
+    out[n++] = EOR_HEAD;
+    out[n++] = frame00FF[0];
+    out[n++] = frame00FF[1];
+    return n;
+}
+
+static uint32 EvPacketVar(uint8 * out, uint8 len, uint8 id)
+{
+    uint32 n = 0;
+    out[n++] = EVVAR_HEAD;
+    out[n++] = frame00FF[0];
+    out[n++] = frame00FF[1];
+    out[n++] = len;
+    out[n++] = id;
+    out[n++] = (uint8)EvRand();
+    for (uint16 i = 0; i < len; i++) out[n++] = (uint8)EvRand();
+    while (0 != (n % 3)) out[n++] = 0x00; //pad to the 3 byte alignment
+    out[n++] = EOR_HEAD;
+    out[n++] = frame00FF[0];
+    out[n++] = frame00FF[1];
+    return n;
+}
+
+uint32 EvStreamMake(uint8 * out, uint32 cap, enum evStreamType type, uint32 nEvents, uint32 seed)
+{
+    uint32 n = 0;
+    evStreamRand = seed ? seed : 1;
+    for (uint32 e = 0; e < nEvents; e++)
+    {
+        if ((cap - n) < (2 * EV_STREAM_MAX_PACKET)) break;
+        uint32 r = EvRand() % 100;
+        switch (type)
+        {
+            case EV_STREAM_FIX:
+                n += EvPacketFix(out + n);
+                break;
+            case EV_STREAM_VAR:
+                n += EvPacketVar(out + n, (uint8)(3 + (EvRand() % 238)), (uint8)(EvRand() % EVHK_ID));
+                break;
+            case EV_STREAM_HK:
+                n += EvPacketVar(out + n, EV_STREAM_HK_LEN, EVHK_ID);
+                break;
+            case EV_STREAM_GARBAGE:
+                if (12 > r) //junk between packets, like a glitch on the SPI or a partial packet after a reset
+                {
+                    uint32 junk = 1 + (EvRand() % 40);
+                    for (uint32 i = 0; i < junk; i++) out[n++] = (uint8)EvRand();
+                }
+                r = EvRand() % 100;
+            case EV_STREAM_MIX: //GARBAGE continues here
+                if (50 > r)
+                {
+                    n += EvPacketFix(out + n);
+                }
+                else if (95 > r)
+                {
+                    n += EvPacketVar(out + n, (uint8)(3 + (EvRand() % 238)), (uint8)(EvRand() % EVHK_ID));
+                }
+                else
+                {
+                    n += EvPacketVar(out + n, EV_STREAM_HK_LEN, EVHK_ID);
+                }
+                break;
+            default:
+                return n;
+        }
+    }
+    return n;
+}
+
+int EvStreamType(const char * name)
+{
+    for (int i = 0; i < EV_STREAM_TYPES; i++)
+    {
+        if (0 == strcmp(name, evStreamName[i])) return i;
+    }
+    return -1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,46 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Synthesized Event PSOC byte streams for the host simulation.
+ * Packet layouts follow what CheckEventPackets expects:
+ *   EVFIX  DB 00 FF d d d FF 00 FF                          (EV_MIN_SIZE bytes)
+ *   EVVAR  DC 00 FF len id d ... d pad FF 00 FF             (len + 9 bytes, padded to 3 bytes)
+ * with id EVHK_ID for the Event PSOC housekeeping packets.
+ *
+ * ========================================
+*/
+
+#ifndef EV_STREAM_H
+#define EV_STREAM_H
+
+#include "project.h"
+
+enum evStreamType {EV_STREAM_FIX, EV_STREAM_VAR, EV_STREAM_HK, EV_STREAM_MIX, EV_STREAM_GARBAGE, EV_STREAM_TYPES};
+
+extern const char * const evStreamName[EV_STREAM_TYPES];
+
+#define EV_STREAM_HK_LEN (78u) //data bytes of a housekeeping packet, fills lowRateHK.eventHK
+#define EV_STREAM_MAX_PACKET (255u + 9u + 2u)
+
+/**
+ * @brief Fills out with a synthesized stream of nEvents packets
+ * @param out destination, at least nEvents * (EV_STREAM_MAX_PACKET + garbage) bytes
+ * @param cap size of out
+ * @param type mix of packets to generate
+ * @param nEvents number of packets to generate
+ * @param seed seed of the pseudo random generator, same seed gives the same stream
+ * @return uint32 number of bytes written
+ */
+uint32 EvStreamMake(uint8 * out, uint32 cap, enum evStreamType type, uint32 nEvents, uint32 seed);
+int EvStreamType(const char * name);
+
+#endif /* EV_STREAM_H */
+/* [] END OF FILE */
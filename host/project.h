@@ -0,0 +1,298 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Host stand-in for the PSoC Creator generated project.h.
+ * Only the component API used by the daq_*.c modules is declared here, with the
+ * same names and signatures as the generated source. The bodies live in
+ * sim_hal.c and model the hardware well enough to replay data through the
+ * real code paths. main.c is not built on the host.
+ *
+ * DMA addresses: the firmware hands the DMA LO16() of SRAM addresses. The host
+ * is linked non-PIE so every static buffer sits below 4GB, LO16() keeps the
+ * whole 32 bit address and the simulated DMA turns it back into a pointer.
+ *
+ * ========================================
+*/
+
+#ifndef PROJECT_H
+#define PROJECT_H
+
+#include <stdint.h>
+
+typedef uint8_t  uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef int8_t   int8;
+typedef int16_t  int16;
+typedef int32_t  int32;
+typedef char     char8;
+typedef volatile uint8  reg8;
+typedef volatile uint16 reg16;
+typedef volatile uint32 reg32;
+typedef uint32 cystatus;
+
+#include "cyapicallbacks.h" //cytypes.h pulls it in on the target
+
+#define CY_ISR(FuncName)        void FuncName (void)
+#define CY_ISR_PROTO(FuncName)  void FuncName (void)
+
+#define CYRET_SUCCESS           (0x00u)
+#define CYRET_UNKNOWN           ((cystatus) 0xFFFFFFFFu)
+#define CYRET_BAD_PARAM         (0x01u)
+#define CYRET_STARTED           (0x07u)
+
+#define CYDEV_SRAM_BASE         (0x1FFF8000u)
+#define CYDEV_PERIPH_BASE       (0x40004000u)
+
+#define LO16(x)                 ((uint32) (x)) /* host keeps the full address, see header */
+#define HI16(x)                 ((uint16) ((uint32) (x) >> 16))
+#define CY_GET_REG16(addr)      (*((const reg16 *)(addr)))
+
+uint8 CyEnterCriticalSection(void);
+void CyExitCriticalSection(uint8 savedIntrStatus);
+#define __DMB()                 __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/* isr_Cm */
+void isr_Cm_Enable(void);
+void isr_Cm_Disable(void);
+uint8 isr_Cm_GetState(void);
+void CySoftwareReset(void);
+void CyDelay(uint32 milliseconds);
+
+/* Clocks (cyfitter.h) and DWT cycle counter (core_cm3.h), TRACE_NOW reads the host time stamp counter */
+#define BCLK__BUS_CLK__HZ       (48000000U)
+typedef struct { reg32 CTRL; reg32 CYCCNT; } DWT_Type;
+typedef struct { reg32 DEMCR; } CoreDebug_Type;
+extern DWT_Type simDWT;
+extern CoreDebug_Type simCoreDebug;
+#define DWT                     (&simDWT)
+#define CoreDebug               (&simCoreDebug)
+#define DWT_CTRL_CYCCNTENA_Msk  (0x1UL)
+#define CoreDebug_DEMCR_TRCENA_Msk (0x1UL << 24)
+uint32 SimCycleCount(void);
+#define TRACE_NOW()             SimCycleCount()
+#define __CLZ(x)                ((uint32) __builtin_clz(x))
+void SimWaitForInterrupt(void);
+#define __WFI()                 SimWaitForInterrupt()
+
+/* DMA controller (cydmac.h) */
+#define CY_DMA_INVALID_CHANNEL  (0xFFu)
+#define CY_DMA_INVALID_TD       (0xFFu)
+#define CY_DMA_END_CHAIN_TD     (0xFFu)
+#define CY_DMA_DISABLE_TD       (0xFEu)
+#define DMA_INVALID_TD          (CY_DMA_INVALID_TD)
+#define DMA_END_CHAIN_TD        (CY_DMA_END_CHAIN_TD)
+#define DMA_DISABLE_TD          (CY_DMA_DISABLE_TD)
+#define CY_DMA_NUMBEROF_TDS     (128u)
+#define CY_DMA_NUMBEROF_CHANNELS (24u)
+#define CY_DMA_TD_SWAP_EN       (0x80u)
+#define CY_DMA_TD_SWAP_SIZE4    (0x40u)
+#define CY_DMA_TD_AUTO_EXEC_NEXT (0x20u)
+#define CY_DMA_TD_TERMIN_EN     (0x10u)
+#define CY_DMA_TD_TERMOUT1_EN   (0x08u)
+#define CY_DMA_TD_TERMOUT0_EN   (0x04u)
+#define CY_DMA_TD_INC_DST_ADR   (0x02u)
+#define CY_DMA_TD_INC_SRC_ADR   (0x01u)
+
+uint8 CyDmaTdAllocate(void);
+void CyDmaTdFree(uint8 tdHandle);
+uint8 CyDmaTdFreeCount(void);
+cystatus CyDmaTdSetConfiguration(uint8 tdHandle, uint16 transferCount, uint8 nextTd, uint8 configuration);
+cystatus CyDmaTdSetAddress(uint8 tdHandle, uint32 source, uint32 destination);
+cystatus CyDmaChSetInitialTd(uint8 chHandle, uint8 startTd);
+cystatus CyDmaChEnable(uint8 chHandle, uint8 preserveTds);
+cystatus CyDmaChDisable(uint8 chHandle);
+cystatus CyDmaClearPendingDrq(uint8 chHandle);
+
+/* working copies of the channel TD, CFG1[0..1] / CFG1[2..3] are the low 16 bits of the source / destination address */
+typedef struct dmac_cfgmem_struct
+{
+    volatile uint8 CFG0[4];
+    volatile uint8 CFG1[4];
+} dmac_cfgmem;
+extern dmac_cfgmem simDmaCfgMem[CY_DMA_NUMBEROF_CHANNELS];
+#define CY_DMA_CFGMEM_STRUCT_PTR    (simDmaCfgMem)
+
+/* DMA_HR_Data */
+#define DMA_HR_Data__TD_TERMOUT_EN (CY_DMA_TD_TERMOUT0_EN)
+uint8 DMA_HR_Data_DmaInitialize(uint8 burstCount, uint8 requestPerBurst, uint16 upperSrcAddress, uint16 upperDestAddress);
+
+/* Status_Reg_UART_DMA, bit 0 is the sticky nrq of DMA_HR_Data */
+uint8 Status_Reg_UART_DMA_Read(void);
+
+/* Control registers */
+void Control_Reg_LoadPulse_Write(uint8 control);
+
+/* Pins */
+void Pin_Busy_Write(uint8 value);
+void Pin_LED1_Write(uint8 value);
+void Pin_LED2_Write(uint8 value);
+uint8 Pin_Reset_Ev_HW_Read(void);
+void Pin_Reset_Ev_HW_Write(uint8 value);
+uint8 Pin_Reset_Ev_SW_Read(void);
+void Pin_Reset_Ev_SW_Write(uint8 value);
+void Pin_Sel2_Pwr_Write(uint8 value);
+void Pin_Sel5_HV1_Write(uint8 value);
+void Pin_Sel6_HV2_Write(uint8 value);
+void Pin_Sel3_J16_Write(uint8 value);
+void Pin_Sel12_J17_Write(uint8 value);
+void Pin_Sel13_J18_Write(uint8 value);
+void Pin_Sel7_J20_Write(uint8 value);
+uint8 Pin_nDrdy_Filter_Read(void);
+
+/* SPIS_Ev, SPI slave fed by the Event PSOC */
+#define SPIS_Ev_STS_RX_BUF_NOT_EMPTY    (0x08u)
+#define SPIS_Ev_STS_RX_FIFO_NOT_EMPTY   (0x08u)
+#define SPIS_Ev_STS_RX_FIFO_OVERRUN     (0x40u)
+uint8 SPIS_Ev_ReadStatus(void);
+uint8 SPIS_Ev_ReadRxData(void);
+uint8 SPIS_Ev_GetRxBufferSize(void);
+
+/* SPIM_BP, backplane SPI master */
+#define SPIM_BP_STS_TX_FIFO_EMPTY       (0x02u)
+#define SPIM_BP_STS_RX_FIFO_NOT_EMPTY   (0x20u)
+extern volatile uint8 simSPIMBPTxStatus;
+#define SPIM_BP_TX_STATUS_REG           (simSPIMBPTxStatus)
+uint8 SPIM_BP_ReadTxStatus(void);
+uint8 SPIM_BP_ReadRxStatus(void);
+void SPIM_BP_WriteTxData(uint8 txData);
+uint8 SPIM_BP_ReadRxData(void);
+
+/* Timer_SelLow, one shot select low period of the backplane readout */
+#define Timer_SelLow_CTRL_ENABLE        (0x80u)
+extern volatile uint8 simTimerSelLowControl;
+#define Timer_SelLow_CONTROL            (simTimerSelLowControl)
+void Timer_SelLow_Start(void);
+void Timer_SelLow_Stop(void);
+uint8 Timer_SelLow_ReadStatusRegister(void);
+
+/* SysTick (CyLib.h) and NVIC (core_cm3.h), pacing ISRTickBP */
+#define CY_SYS_SYST_CSR_CLK_SRC_SYSCLK  (1u)
+#define SysTick_IRQn                    (-1)
+#define isr_R__INTC_PRIOR_NUM           (7u)
+typedef void (* cySysTickCallback)(void);
+void CySysTickStart(void);
+void CySysTickSetClockSource(uint32 clockSource);
+void CySysTickSetReload(uint32 value);
+void CySysTickClear(void);
+uint32 CySysTickGetReload(void);
+uint32 CySysTickGetValue(void);
+uint32 CySysTickGetCountFlag(void);
+cySysTickCallback CySysTickSetCallback(uint32 number, cySysTickCallback function);
+void NVIC_SetPriority(int32 IRQn, uint32 priority);
+
+/* UART_HR_Data, high rate frame output */
+#define UART_HR_Data_TX_STS_COMPLETE    (0x01u)
+#define UART_HR_Data_TX_STS_FIFO_EMPTY  (0x02u)
+#define UART_HR_Data_TX_STS_FIFO_FULL   (0x04u)
+extern reg8 simUARTHRDataTxReg;
+#define UART_HR_Data_TXDATA_PTR         (&simUARTHRDataTxReg)
+void UART_HR_Data_PutChar(uint8 txDataByte);
+uint8 UART_HR_Data_ReadTxStatus(void);
+
+/* UART_Cmd, commands to the Event PSOC */
+#define UART_Cmd_TX_STS_FIFO_FULL       (0x04u)
+void UART_Cmd_PutChar(uint8 txDataByte);
+uint8 UART_Cmd_ReadTxStatus(void);
+void SimUartCmdSetPendingTxInt(void);
+#define UART_Cmd_SetPendingTxInt()      SimUartCmdSetPendingTxInt()
+#define UART_Cmd_TX_BUFFER_SIZE         (29u)
+
+/* UART_LR_Data, low rate science data */
+void UART_LR_Data_PutArray(const uint8 string[], uint8 byteCount);
+uint8 UART_LR_Data_GetTxBufferSize(void);
+
+/* UART_LR_Cmd_1 & UART_LR_Cmd_2, ground command inputs */
+#define UART_LR_Cmd_1_RX_STS_FIFO_NOTEMPTY (0x20u)
+#define UART_LR_Cmd_2_RX_STS_FIFO_NOTEMPTY (0x20u)
+uint8 UART_LR_Cmd_1_ReadRxStatus(void);
+uint8 UART_LR_Cmd_1_ReadRxData(void);
+uint8 UART_LR_Cmd_1_GetRxBufferSize(void);
+uint8 UART_LR_Cmd_2_ReadRxStatus(void);
+uint8 UART_LR_Cmd_2_ReadRxData(void);
+uint8 UART_LR_Cmd_2_GetRxBufferSize(void);
+
+/* USBUART_CD, USB CDC */
+uint8 USBUART_CD_GetConfiguration(void);
+uint8 USBUART_CD_IsConfigurationChanged(void);
+uint8 USBUART_CD_CDC_Init(void);
+uint8 USBUART_CD_CDCIsReady(void);
+void USBUART_CD_PutData(const uint8* pData, uint16 length);
+uint8 USBUART_CD_DataIsReady(void);
+uint16 USBUART_CD_GetAll(uint8* pData);
+
+/* I2C_RTC, housekeeping I2C master */
+#define I2C_RTC_MODE_COMPLETE_XFER      (0x00u)
+#define I2C_RTC_MODE_REPEAT_START       (0x01u)
+#define I2C_RTC_MODE_NO_STOP            (0x02u)
+#define I2C_RTC_MSTAT_RD_CMPLT          (0x01u)
+#define I2C_RTC_MSTAT_WR_CMPLT          (0x02u)
+#define I2C_RTC_MSTAT_XFER_INP          (0x04u)
+#define I2C_RTC_MSTAT_XFER_HALT         (0x08u)
+#define I2C_RTC_MSTAT_ERR_MASK          (0xF0u)
+#define I2C_RTC_MSTAT_ERR_SHORT_XFER    (0x10u)
+#define I2C_RTC_MSTAT_ERR_ADDR_NAK      (0x20u)
+#define I2C_RTC_MSTAT_ERR_ARB_LOST      (0x40u)
+#define I2C_RTC_MSTAT_ERR_XFER          (0x80u)
+uint8 I2C_RTC_MasterStatus(void);
+uint8 I2C_RTC_MasterClearStatus(void);
+uint8 I2C_RTC_MasterWriteBuf(uint8 slaveAddress, uint8 * wrData, uint8 cnt, uint8 mode);
+uint8 I2C_RTC_MasterReadBuf(uint8 slaveAddress, uint8 * rdData, uint8 cnt, uint8 mode);
+
+/* RTC_Main */
+typedef struct
+{
+    uint8  Sec;
+    uint8  Min;
+    uint8  Hour;
+    uint8  DayOfWeek;
+    uint8  DayOfMonth;
+    uint16 DayOfYear;
+    uint8  Month;
+    uint16 Year;
+} RTC_Main_TIME_DATE;
+void RTC_Main_Start(void);
+void RTC_Main_Init(void);
+void RTC_Main_EnableInt(void);
+void RTC_Main_DisableInt(void);
+RTC_Main_TIME_DATE * RTC_Main_ReadTime(void);
+void RTC_Main_WriteTime(const RTC_Main_TIME_DATE * timeDate);
+
+/* Barometer capture counters */
+#define Counter_BaroTemp1_STATUS_FIFONEMP (0x08u)
+#define Counter_BaroTemp2_STATUS_FIFONEMP (0x08u)
+#define Counter_BaroPres1_STATUS_FIFONEMP (0x08u)
+#define Counter_BaroPres2_STATUS_FIFONEMP (0x08u)
+uint8 Counter_BaroTemp1_ReadStatusRegister(void);
+uint8 Counter_BaroTemp2_ReadStatusRegister(void);
+uint8 Counter_BaroPres1_ReadStatusRegister(void);
+uint8 Counter_BaroPres2_ReadStatusRegister(void);
+uint16 Counter_BaroTemp1_ReadCapture(void);
+uint16 Counter_BaroTemp2_ReadCapture(void);
+uint16 Counter_BaroPres1_ReadCapture(void);
+uint16 Counter_BaroPres2_ReadCapture(void);
+
+/* DieTemp_Main */
+cystatus DieTemp_Main_Start(void);
+cystatus DieTemp_Main_Query(int16 * temperature);
+
+/* cy_boot CyFlash, the on-chip EEPROM. CyWriteRowData blocks SIM_EEPROM_ROW_NS, the interrupts keep running */
+extern uint8 simEEPROM[2048];
+#define CYDEV_EE_BASE           ((uint32) simEEPROM)
+#define CYDEV_EE_SIZE           (0x00000800u)
+#define CYDEV_EEPROM_ROW_SIZE   (0x00000010u)
+#define CY_SPC_FIRST_EE_ARRAYID (0x40u)
+void CyEEPROM_Start(void);
+cystatus CySetTemp(void);
+cystatus CyWriteRowData(uint8 arrayId, uint16 rowAddress, const uint8 * rowData);
+
+#endif /* PROJECT_H */
+/* [] END OF FILE */
@@ -0,0 +1,166 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Per byte cost of the ring buffer index math. Pushes and pops bytes through
+ * a ring the way ISRReadEv and CheckFrameBuffer do, with the indices volatile
+ * like the globals shared with the ISRs:
+ *   wrap1536   WRAPINC / ACTIVELEN with the FRAME_BUFFER_SIZE like size 1536
+ *   wrap1024   WRAPINC / ACTIVELEN with a power of 2 size given as a signed int
+ *   ring1024   RING_INC / RING_LEN
+ *   span1024   RING_FREE / RING_SPAN memcpy of whole contiguous spans
+ * The host compiler turns % by a constant into a multiply, the Cortex-M3 GCC
+ * build does the same or uses udiv, so the gap here is the lower bound.
+ *
+ * Usage: ring_bench [-n megabytes] [-c chunk]
+ *
+ * ========================================
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include <time.h>
+#include "daq.h"
+
+#define RING_BENCH_WRAP_SIZE 1536 //not a power of 2, like FRAME_BUFFER_SIZE
+#define RING_BENCH_SIZE 1024 //signed like CMD_BUFFER_SIZE
+#define RING_BENCH_SIZE_U (1024u)
+
+static uint8 ringData[RING_BENCH_WRAP_SIZE];
+static volatile uint16 ringRead;
+static volatile uint16 ringWrite;
+static uint8 ringSrc[256];
+static uint8 ringDst[256];
+static volatile uint32 ringSum;
+
+static inline uint64_t RingCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + ts.tv_nsec;
+#endif
+}
+
+static void RingWrap1536(uint32 chunk)
+{
+    for (uint32 i = 0; i < chunk; i++)
+    {
+        if (WRAPINC(ringWrite, RING_BENCH_WRAP_SIZE) == ringRead) break;
+        ringData[ringWrite] = ringSrc[i];
+        ringWrite = WRAPINC(ringWrite, RING_BENCH_WRAP_SIZE);
+    }
+    uint32 sum = 0;
+    while (0 < ACTIVELEN(ringRead, ringWrite, RING_BENCH_WRAP_SIZE))
+    {
+        sum += ringData[ringRead];
+        ringRead = WRAPINC(ringRead, RING_BENCH_WRAP_SIZE);
+    }
+    ringSum += sum;
+}
+
+static void RingWrap1024(uint32 chunk)
+{
+    for (uint32 i = 0; i < chunk; i++)
+    {
+        if (WRAPINC(ringWrite, RING_BENCH_SIZE) == ringRead) break;
+        ringData[ringWrite] = ringSrc[i];
+        ringWrite = WRAPINC(ringWrite, RING_BENCH_SIZE);
+    }
+    uint32 sum = 0;
+    while (0 < ACTIVELEN(ringRead, ringWrite, RING_BENCH_SIZE))
+    {
+        sum += ringData[ringRead];
+        ringRead = WRAPINC(ringRead, RING_BENCH_SIZE);
+    }
+    ringSum += sum;
+}
+
+static void RingMask1024(uint32 chunk)
+{
+    for (uint32 i = 0; i < chunk; i++)
+    {
+        if (0 == RING_FREE(ringRead, ringWrite, RING_BENCH_SIZE)) break;
+        ringData[ringWrite] = ringSrc[i];
+        ringWrite = RING_INC(ringWrite, RING_BENCH_SIZE);
+    }
+    uint32 sum = 0;
+    while (0 < RING_LEN(ringRead, ringWrite, RING_BENCH_SIZE))
+    {
+        sum += ringData[ringRead];
+        ringRead = RING_INC(ringRead, RING_BENCH_SIZE);
+    }
+    ringSum += sum;
+}
+
+static void RingSpan1024(uint32 chunk)
+{
+    uint32 done = 0;
+    while (done < chunk)
+    {
+        uint16 n = MIN(MIN(RING_FREE(ringRead, ringWrite, RING_BENCH_SIZE_U), RING_BENCH_SIZE_U - ringWrite), chunk - done);
+        if (0 == n) break;
+        memcpy(&ringData[ringWrite], &ringSrc[done], n);
+        ringWrite = RING_ADD(ringWrite, n, RING_BENCH_SIZE_U);
+        done += n;
+    }
+    uint16 n;
+    while (0 < (n = RING_SPAN(ringRead, ringWrite, RING_BENCH_SIZE_U)))
+    {
+        memcpy(ringDst, &ringData[ringRead], MIN(n, sizeof(ringDst)));
+        ringRead = RING_ADD(ringRead, MIN(n, sizeof(ringDst)), RING_BENCH_SIZE_U);
+    }
+    ringSum += ringDst[0];
+}
+
+static void RingRun(const char * name, void (*fn)(uint32), uint32 chunk, uint64_t bytes)
+{
+    ringRead = ringWrite = 0;
+    uint64_t passes = bytes / chunk;
+    uint64_t c0 = RingCycles();
+    for (uint64_t p = 0; p < passes; p++) fn(chunk);
+    uint64_t c1 = RingCycles();
+    printf("%-10s %8.2f cyc/B\n", name, (double)(c1 - c0) / (passes * chunk));
+}
+
+int main(int argc, char ** argv)
+{
+    uint32 mb = 64;
+    uint32 chunk = 27; //FRAME_DATA_BYTES
+    int opt;
+    while (-1 != (opt = getopt(argc, argv, "n:c:")))
+    {
+        switch (opt)
+        {
+            case 'n': mb = strtoul(optarg, NULL, 0); break;
+            case 'c': chunk = strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-n megabytes] [-c chunk]\n", argv[0]);
+                return 1;
+        }
+    }
+    if ((0 == chunk) || (sizeof(ringSrc) < chunk) || (0 == mb)) return 1;
+    for (uint32 i = 0; i < sizeof(ringSrc); i++) ringSrc[i] = (uint8)(i * 7);
+    printf("%u MB through the ring in chunks of %u bytes\n", mb, chunk);
+    uint64_t bytes = (uint64_t)mb << 20;
+    RingRun("wrap1536", RingWrap1536, chunk, bytes);
+    RingRun("wrap1024", RingWrap1024, chunk, bytes);
+    RingRun("ring1024", RingMask1024, chunk, bytes);
+    RingRun("span1024", RingSpan1024, chunk, bytes);
+    return 0;
+}
+
+/* [] END OF FILE */
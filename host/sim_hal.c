@@ -0,0 +1,1146 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Simulated PSoC components for the host build. Each component keeps just
+ * enough state to behave like the hardware as seen by the daq_*.c modules:
+ * FIFOs with their real depths, UARTs that drain at their baud rate, a DMA
+ * controller that runs TD chains, sticky status registers and interrupts
+ * that are raised by the peripherals and serviced between main loop passes.
+ *
+ * ========================================
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include <time.h>
+#include "daq.h"
+#include "sim_hal.h"
+
+#define SIM_TIME_NEVER (~(uint64_t)0)
+#define SIM_UART_RING (1024u)
+#define SIM_BP_PACKETS (64u)
+
+uint64_t simTimeNs = 0;
+SimTiming simTiming;
+SimStats simStats;
+SimSink simSinkHR;
+SimSink simSinkUSB;
+SimSink simSinkCmd;
+SimSink simSinkLRData;
+uint8 simUsbConnected = TRUE;
+
+/* DWT, the trace reads the host clock instead */
+DWT_Type simDWT;
+CoreDebug_Type simCoreDebug;
+
+uint32 SimCycleCount(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return (uint32)__rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32)(((uint64_t)ts.tv_sec * 1000000000ull) + ts.tv_nsec);
+#endif
+}
+
+static uint8 simIntMask = FALSE; //TRUE inside a critical section or an ISR
+static uint8 simIsrPending[SIM_ISR_NUM];
+static uint8 simIsrCmEnabled = TRUE; //isr_Cm_Disable masks ISRCheckCmd only
+
+/* ---------------- sinks ---------------- */
+
+static void SimSinkPut(SimSink * sink, uint8 data)
+{
+    sink->bytes++;
+    if (NULL != sink->file)
+    {
+        fputc(data, sink->file);
+    }
+    if (sink->keepCapture)
+    {
+        if (sink->captureLen >= sink->captureCap)
+        {
+            sink->captureCap = sink->captureCap ? (sink->captureCap * 2) : 4096;
+            sink->capture = realloc(sink->capture, sink->captureCap);
+        }
+        sink->capture[sink->captureLen++] = data;
+    }
+}
+
+void SimSinkReset(SimSink * sink)
+{
+    sink->captureLen = 0;
+    sink->bytes = 0;
+    sink->packets = 0;
+}
+
+/* ---------------- UART TX model, FIFO plus optional software buffer ---------------- */
+
+typedef struct SimUartTx {
+    uint8 buf[SIM_UART_RING];
+    uint16 head;
+    uint16 count;
+    uint16 cap; //hardware FIFO plus software buffer
+    uint64_t shiftEnd; //time the byte in the shifter is done
+    uint32 * byteNs;
+    SimSink * sink;
+    uint8 * txIsrPending; //TX interrupt on the FIFO going empty, NULL for none
+} SimUartTx;
+
+static SimUartTx simHR;
+static SimUartTx simCmd;
+static SimUartTx simLRData;
+reg8 simUARTHRDataTxReg;
+
+static void SimUartTxStep(SimUartTx * u)
+{
+    if ((u->shiftEnd <= simTimeNs) && (0 < u->count))
+    {
+        SimSinkPut(u->sink, u->buf[u->head]);
+        u->head = (u->head + 1) % SIM_UART_RING;
+        u->count--;
+        u->shiftEnd = simTimeNs + *(u->byteNs);
+        if ((0 == u->count) && (NULL != u->txIsrPending)) *(u->txIsrPending) = TRUE;
+    }
+}
+
+static uint64_t SimUartTxNext(SimUartTx * u)
+{
+    if (0 < u->count)
+    {
+        return (u->shiftEnd > simTimeNs) ? u->shiftEnd : simTimeNs;
+    }
+    return SIM_TIME_NEVER;
+}
+
+static void SimUartTxPut(SimUartTx * u, uint8 data)
+{
+    while (u->count >= u->cap) //blocking like the generated PutChar
+    {
+        SimAdvance(SimUartTxNext(u) - simTimeNs + 1);
+    }
+    u->buf[(u->head + u->count) % SIM_UART_RING] = data;
+    u->count++;
+    SimUartTxStep(u); //start shifting if idle
+}
+
+static uint8 SimUartTxSoftCount(SimUartTx * u)
+{
+    return (u->count > SIM_UART_FIFO_SIZE) ? (uint8)MIN(255, u->count - SIM_UART_FIFO_SIZE) : 0;
+}
+
+/* ---------------- byte FIFO used for the RX side ---------------- */
+
+typedef struct SimRxFifo {
+    uint8 buf[SIM_RX_BUFFER_SIZE];
+    uint16 head;
+    uint16 count;
+    uint16 cap;
+} SimRxFifo;
+
+static uint32 SimRxPush(SimRxFifo * f, const uint8 * data, uint32 len)
+{
+    uint32 n = 0;
+    while ((n < len) && (f->count < f->cap))
+    {
+        f->buf[(f->head + f->count) % SIM_RX_BUFFER_SIZE] = data[n++];
+        f->count++;
+    }
+    return n;
+}
+
+static uint8 SimRxPop(SimRxFifo * f)
+{
+    uint8 data = 0;
+    if (0 < f->count)
+    {
+        data = f->buf[f->head];
+        f->head = (f->head + 1) % SIM_RX_BUFFER_SIZE;
+        f->count--;
+    }
+    return data;
+}
+
+static SimRxFifo simSPISEv;
+static SimRxFifo simLRCmd[2];
+static SimRxFifo simUsbRx;
+
+/* ---------------- DMA controller ---------------- */
+
+typedef struct SimDmaTd {
+    uint8 used;
+    uint8 next;
+    uint8 config;
+    uint16 count;
+    uint32 src;
+    uint32 dst;
+} SimDmaTd;
+
+typedef struct SimDmaChan {
+    uint8 used;
+    uint8 enabled;
+    uint8 preserve;
+    uint8 loaded;
+    uint8 initTd;
+    uint8 curTd;
+    uint8 burst;
+    uint16 count;
+    uint32 src;
+    uint32 dst;
+    uint8 (*drq)(void);
+    void (*nrq)(void);
+} SimDmaChan;
+
+static SimDmaTd simTd[CY_DMA_NUMBEROF_TDS];
+static SimDmaChan simChan[CY_DMA_NUMBEROF_CHANNELS];
+dmac_cfgmem simDmaCfgMem[CY_DMA_NUMBEROF_CHANNELS];
+static uint8 simStatusRegUARTDMA = 0;
+
+static uint8 SimBusRead(uint32 addr)
+{
+    return *((volatile uint8 *)(uintptr_t)addr);
+}
+
+static void SimBusWrite(uint32 addr, uint8 data)
+{
+    if (addr == (uint32)(uintptr_t)&simUARTHRDataTxReg)
+    {
+        SimUartTxPut(&simHR, data);
+        return;
+    }
+    *((volatile uint8 *)(uintptr_t)addr) = data;
+}
+
+static void SimDmaService(void)
+{
+    for (uint8 ch = 0; ch < CY_DMA_NUMBEROF_CHANNELS; ch++)
+    {
+        SimDmaChan * c = &simChan[ch];
+        while (c->enabled && (NULL != c->drq) && c->drq())
+        {
+            SimDmaTd * td = &simTd[c->curTd];
+            if (!c->loaded)
+            {
+                c->count = td->count;
+                c->src = td->src;
+                c->dst = td->dst;
+                c->loaded = TRUE;
+            }
+            for (uint8 b = 0; (b < c->burst) && (0 < c->count); b++)
+            {
+                SimBusWrite(c->dst, SimBusRead(c->src));
+                if (td->config & CY_DMA_TD_INC_SRC_ADR) c->src++;
+                if (td->config & CY_DMA_TD_INC_DST_ADR) c->dst++;
+                c->count--;
+                simStats.dmaBytes++;
+            }
+            *((reg16 *)&simDmaCfgMem[ch].CFG1[0]) = (uint16)c->src;
+            *((reg16 *)&simDmaCfgMem[ch].CFG1[2]) = (uint16)c->dst;
+            if (0 == c->count)
+            {
+                simStats.dmaTdDone++;
+                if (!c->preserve)
+                {
+                    td->count = 0;
+                    td->src = c->src;
+                    td->dst = c->dst;
+                }
+                if ((td->config & (CY_DMA_TD_TERMOUT0_EN | CY_DMA_TD_TERMOUT1_EN)) && (NULL != c->nrq))
+                {
+                    c->nrq();
+                }
+                c->loaded = FALSE;
+                if ((CY_DMA_DISABLE_TD == td->next) || (CY_DMA_END_CHAIN_TD == td->next))
+                {
+                    c->enabled = FALSE;
+                }
+                else
+                {
+                    c->curTd = td->next;
+                }
+            }
+        }
+    }
+}
+
+uint8 CyDmaTdAllocate(void)
+{
+    for (uint8 i = 0; i < CY_DMA_NUMBEROF_TDS; i++)
+    {
+        if (!simTd[i].used)
+        {
+            memset(&simTd[i], 0, sizeof(SimDmaTd));
+            simTd[i].used = TRUE;
+            return i;
+        }
+    }
+    return CY_DMA_INVALID_TD;
+}
+
+void CyDmaTdFree(uint8 tdHandle)
+{
+    if (tdHandle < CY_DMA_NUMBEROF_TDS) simTd[tdHandle].used = FALSE;
+}
+
+uint8 CyDmaTdFreeCount(void)
+{
+    uint8 n = 0;
+    for (uint8 i = 0; i < CY_DMA_NUMBEROF_TDS; i++) if (!simTd[i].used) n++;
+    return n;
+}
+
+cystatus CyDmaTdSetConfiguration(uint8 tdHandle, uint16 transferCount, uint8 nextTd, uint8 configuration)
+{
+    if (tdHandle >= CY_DMA_NUMBEROF_TDS) return CYRET_BAD_PARAM;
+    simTd[tdHandle].count = transferCount & 0x0FFF;
+    simTd[tdHandle].next = nextTd;
+    simTd[tdHandle].config = configuration;
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaTdSetAddress(uint8 tdHandle, uint32 source, uint32 destination)
+{
+    if (tdHandle >= CY_DMA_NUMBEROF_TDS) return CYRET_BAD_PARAM;
+    simTd[tdHandle].src = source;
+    simTd[tdHandle].dst = destination;
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaChSetInitialTd(uint8 chHandle, uint8 startTd)
+{
+    if (chHandle >= CY_DMA_NUMBEROF_CHANNELS) return CYRET_BAD_PARAM;
+    simChan[chHandle].initTd = startTd;
+    simChan[chHandle].curTd = startTd;
+    simChan[chHandle].loaded = FALSE;
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaChEnable(uint8 chHandle, uint8 preserveTds)
+{
+    if (chHandle >= CY_DMA_NUMBEROF_CHANNELS) return CYRET_BAD_PARAM;
+    simChan[chHandle].enabled = TRUE;
+    simChan[chHandle].preserve = preserveTds;
+    SimDmaService();
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaChDisable(uint8 chHandle)
+{
+    if (chHandle >= CY_DMA_NUMBEROF_CHANNELS) return CYRET_BAD_PARAM;
+    simChan[chHandle].enabled = FALSE;
+    simChan[chHandle].loaded = FALSE;
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaClearPendingDrq(uint8 chHandle)
+{
+    (void)chHandle; //requests are level based in the model
+    return CYRET_SUCCESS;
+}
+
+static uint8 SimHRDrq(void)
+{
+    return (simHR.count < simHR.cap);
+}
+
+static void SimHRNrq(void)
+{
+    simStatusRegUARTDMA |= 0x01u;
+}
+
+uint8 DMA_HR_Data_DmaInitialize(uint8 burstCount, uint8 requestPerBurst, uint16 upperSrcAddress, uint16 upperDestAddress)
+{
+    (void)requestPerBurst; (void)upperSrcAddress; (void)upperDestAddress;
+    SimDmaChan * c = &simChan[0];
+    memset(c, 0, sizeof(SimDmaChan));
+    c->used = TRUE;
+    c->burst = burstCount ? burstCount : 1;
+    c->drq = SimHRDrq;
+    c->nrq = SimHRNrq;
+    return 0;
+}
+
+uint8 Status_Reg_UART_DMA_Read(void)
+{
+    uint8 status = simStatusRegUARTDMA; //sticky, cleared on read
+    simStatusRegUARTDMA = 0;
+    return status;
+}
+
+/* ---------------- CPU ---------------- */
+
+uint8 CyEnterCriticalSection(void)
+{
+    uint8 state = simIntMask;
+    simIntMask = TRUE;
+    return state;
+}
+
+void CyExitCriticalSection(uint8 savedIntrStatus)
+{
+    simIntMask = savedIntrStatus;
+}
+
+void isr_Cm_Enable(void)
+{
+    simIsrCmEnabled = TRUE;
+}
+
+void isr_Cm_Disable(void)
+{
+    simIsrCmEnabled = FALSE;
+}
+
+uint8 isr_Cm_GetState(void)
+{
+    return simIsrCmEnabled;
+}
+
+void CySoftwareReset(void)
+{
+    simStats.resets++;
+    fprintf(stderr, "sim: CySoftwareReset at %llu ns\n", (unsigned long long)simTimeNs);
+}
+
+void CyDelay(uint32 milliseconds)
+{
+    SimAdvance((uint64_t)milliseconds * 1000000ull);
+}
+
+/* ---------------- pins & control registers ---------------- */
+
+static uint8 simPinResetEvHW = 1;
+static uint8 simPinResetEvSW = 0;
+
+void Control_Reg_LoadPulse_Write(uint8 control) { (void)control; }
+void Pin_Busy_Write(uint8 value) { (void)value; }
+void Pin_LED1_Write(uint8 value) { (void)value; }
+void Pin_LED2_Write(uint8 value) { (void)value; }
+uint8 Pin_Reset_Ev_HW_Read(void) { return simPinResetEvHW; }
+void Pin_Reset_Ev_HW_Write(uint8 value) { simPinResetEvHW = value; }
+uint8 Pin_Reset_Ev_SW_Read(void) { return simPinResetEvSW; }
+void Pin_Reset_Ev_SW_Write(uint8 value) { simPinResetEvSW = value; }
+
+/* ---------------- backplane boards, select lines and SPIM_BP ---------------- */
+
+typedef struct SimBPBoard {
+    uint8 buf[SIM_BP_BOARD_BUFFER];
+    uint16 head;
+    uint16 count;
+    uint16 pktLen[SIM_BP_PACKETS];
+    uint8 pktHead;
+    uint8 pktCount;
+    uint16 remaining; //bytes left of the packet being read out, nDrdy low while > 0
+    uint8 sel;
+    uint8 ended; //last packet read out, the next one waits for select low
+} SimBPBoard;
+
+static SimBPBoard simBP[SIM_BP_LINES];
+static uint8 simBPActive = SIM_BP_SEL2_PWR;
+volatile uint8 simSPIMBPTxStatus = SPIM_BP_STS_TX_FIFO_EMPTY;
+static uint8 simSPIMBPRx[4];
+static uint8 simSPIMBPRxCount = 0;
+static uint8 simSPIMBPShift = 0;
+static uint64_t simSPIMBPDone = SIM_TIME_NEVER;
+volatile uint8 simTimerSelLowControl = 0;
+static uint8 simTimerSelLowStatus = 0;
+static uint64_t simTimerSelLowExpire = SIM_TIME_NEVER;
+
+/**
+ * @brief Makes the next queued packet of a board ready (nDrdy low), once the last one was read and select went low
+ */
+static void SimBPNextPacket(SimBPBoard * b)
+{
+    if ((0 == b->remaining) && (!b->ended) && (0 < b->pktCount))
+    {
+        b->remaining = b->pktLen[b->pktHead];
+        b->pktHead = (b->pktHead + 1) % SIM_BP_PACKETS;
+        b->pktCount--;
+    }
+}
+
+static void SimBPSelect(uint8 line, uint8 value)
+{
+    SimBPBoard * b = &simBP[line];
+    if (0u != value) simBPActive = line; //the board selected high drives nDrdy and MISO
+    else b->ended = FALSE;
+    b->sel = value;
+    SimBPNextPacket(b);
+}
+
+void Pin_Sel2_Pwr_Write(uint8 value) { SimBPSelect(SIM_BP_SEL2_PWR, value); }
+void Pin_Sel5_HV1_Write(uint8 value) { SimBPSelect(SIM_BP_SEL5_HV1, value); }
+void Pin_Sel6_HV2_Write(uint8 value) { SimBPSelect(SIM_BP_SEL6_HV2, value); }
+void Pin_Sel3_J16_Write(uint8 value) { SimBPSelect(SIM_BP_SEL3_J16, value); }
+void Pin_Sel12_J17_Write(uint8 value) { SimBPSelect(SIM_BP_SEL12_J17, value); }
+void Pin_Sel13_J18_Write(uint8 value) { SimBPSelect(SIM_BP_SEL13_J18, value); }
+void Pin_Sel7_J20_Write(uint8 value) { SimBPSelect(SIM_BP_SEL7_J20, value); }
+
+uint8 Pin_nDrdy_Filter_Read(void)
+{
+    return (0 < simBP[simBPActive].remaining) ? 0u : 1u;
+}
+
+uint32 SimBPQueue(uint8 line, const uint8 * data, uint32 len)
+{
+    SimBPBoard * b = &simBP[line];
+    if ((SIM_BP_LINES <= line) || (SIM_BP_PACKETS <= b->pktCount) || ((SIM_BP_BOARD_BUFFER - b->count) < len) || (0 == len))
+    {
+        return 0;
+    }
+    for (uint32 i = 0; i < len; i++)
+    {
+        b->buf[(b->head + b->count) % SIM_BP_BOARD_BUFFER] = data[i];
+        b->count++;
+    }
+    b->pktLen[(b->pktHead + b->pktCount) % SIM_BP_PACKETS] = len;
+    b->pktCount++;
+    SimBPNextPacket(b);
+    return len;
+}
+
+uint8 SPIM_BP_ReadTxStatus(void)
+{
+    return simSPIMBPTxStatus;
+}
+
+uint8 SPIM_BP_ReadRxStatus(void)
+{
+    return (0 < simSPIMBPRxCount) ? SPIM_BP_STS_RX_FIFO_NOT_EMPTY : 0u;
+}
+
+void SPIM_BP_WriteTxData(uint8 txData)
+{
+    (void)txData;
+    SimBPBoard * b = &simBP[simBPActive];
+    simSPIMBPShift = 0xFF; //idle MISO
+    if (0 < b->remaining)
+    {
+        simSPIMBPShift = b->buf[b->head];
+        b->head = (b->head + 1) % SIM_BP_BOARD_BUFFER;
+        b->count--;
+        b->remaining--;
+        b->ended = (0 == b->remaining);
+    }
+    simSPIMBPTxStatus = 0;
+    simSPIMBPDone = simTimeNs + simTiming.bpByteNs;
+}
+
+uint8 SPIM_BP_ReadRxData(void)
+{
+    uint8 data = simSPIMBPRx[0];
+    if (0 < simSPIMBPRxCount)
+    {
+        memmove(simSPIMBPRx, simSPIMBPRx + 1, sizeof(simSPIMBPRx) - 1);
+        simSPIMBPRxCount--;
+    }
+    return data;
+}
+
+void Timer_SelLow_Start(void)
+{
+    simTimerSelLowControl |= Timer_SelLow_CTRL_ENABLE;
+    simTimerSelLowExpire = simTimeNs + simTiming.selLowNs;
+}
+
+void Timer_SelLow_Stop(void)
+{
+    simTimerSelLowControl &= ~Timer_SelLow_CTRL_ENABLE;
+    simTimerSelLowExpire = SIM_TIME_NEVER;
+}
+
+uint8 Timer_SelLow_ReadStatusRegister(void)
+{
+    uint8 status = simTimerSelLowStatus;
+    simTimerSelLowStatus = 0;
+    return status;
+}
+
+/* ---------------- SysTick ---------------- */
+
+static uint32 simSysTickReload = (BCLK__BUS_CLK__HZ / 1000u) - 1u; //CySysTickStart sets 1 ms
+static cySysTickCallback simSysTickCallback = NULL;
+static uint64_t simSysTickNext = SIM_TIME_NEVER;
+static uint32 simSysTickCountFlag = 0; //COUNTFLAG, set when the counter wraps, cleared by a read or CySysTickClear
+
+static uint64_t SimSysTickNs(void)
+{
+    return (((uint64_t)simSysTickReload + 1u) * SIM_NS_PER_SEC) / BCLK__BUS_CLK__HZ;
+}
+
+void CySysTickStart(void)
+{
+    simSysTickNext = simTimeNs + SimSysTickNs();
+}
+
+void CySysTickSetClockSource(uint32 clockSource) { (void)clockSource; }
+
+void CySysTickSetReload(uint32 value)
+{
+    simSysTickReload = value & 0x00FFFFFFu;
+}
+
+void CySysTickClear(void)
+{
+    if (SIM_TIME_NEVER != simSysTickNext) simSysTickNext = simTimeNs + SimSysTickNs();
+    simSysTickCountFlag = 0;
+}
+
+uint32 CySysTickGetReload(void)
+{
+    return simSysTickReload;
+}
+
+uint32 CySysTickGetValue(void)
+{
+    if (SIM_TIME_NEVER == simSysTickNext) return 0;
+    uint64_t cycles = ((simSysTickNext - simTimeNs) * BCLK__BUS_CLK__HZ) / SIM_NS_PER_SEC; //bus clocks to the wrap
+    return (0 == cycles) ? 0 : (uint32)MIN(cycles - 1u, simSysTickReload);
+}
+
+uint32 CySysTickGetCountFlag(void)
+{
+    uint32 flag = simSysTickCountFlag;
+    simSysTickCountFlag = 0;
+    return flag;
+}
+
+cySysTickCallback CySysTickSetCallback(uint32 number, cySysTickCallback function)
+{
+    (void)number;
+    cySysTickCallback old = simSysTickCallback;
+    simSysTickCallback = function;
+    return old;
+}
+
+void NVIC_SetPriority(int32 IRQn, uint32 priority) { (void)IRQn; (void)priority; }
+
+/* ---------------- SPIS_Ev ---------------- */
+
+static const uint8 * simEvSrc = NULL;
+static uint32 simEvSrcLen = 0;
+static uint32 simEvSrcPos = 0;
+static uint64_t simEvNext = SIM_TIME_NEVER;
+
+uint8 SPIS_Ev_ReadStatus(void)
+{
+    return (0 < simSPISEv.count) ? SPIS_Ev_STS_RX_BUF_NOT_EMPTY : 0u;
+}
+
+uint8 SPIS_Ev_ReadRxData(void)
+{
+    return SimRxPop(&simSPISEv);
+}
+
+uint8 SPIS_Ev_GetRxBufferSize(void)
+{
+    return (uint8)simSPISEv.count;
+}
+
+uint32 SimEvPush(const uint8 * data, uint32 len)
+{
+    uint32 n = SimRxPush(&simSPISEv, data, len);
+    simStats.evBytesIn += n;
+    simStats.evOverruns += (len - n);
+    return n;
+}
+
+void SimEvSetSource(const uint8 * data, uint32 len)
+{
+    simEvSrc = data;
+    simEvSrcLen = len;
+    simEvSrcPos = 0;
+    simEvNext = (0 < len) ? simTimeNs : SIM_TIME_NEVER;
+}
+
+uint32 SimEvSourceLeft(void)
+{
+    return simEvSrcLen - simEvSrcPos;
+}
+
+/* ---------------- UARTs ---------------- */
+
+void UART_HR_Data_PutChar(uint8 txDataByte)
+{
+    SimUartTxPut(&simHR, txDataByte);
+}
+
+uint8 UART_HR_Data_ReadTxStatus(void)
+{
+    uint8 status = 0;
+    if (0 == simHR.count) status |= UART_HR_Data_TX_STS_FIFO_EMPTY;
+    if ((0 == simHR.count) && (simHR.shiftEnd <= simTimeNs)) status |= UART_HR_Data_TX_STS_COMPLETE;
+    if (simHR.count >= simHR.cap) status |= UART_HR_Data_TX_STS_FIFO_FULL;
+    return status;
+}
+
+void UART_Cmd_PutChar(uint8 txDataByte)
+{
+    SimUartTxPut(&simCmd, txDataByte);
+}
+
+uint8 UART_Cmd_ReadTxStatus(void)
+{
+    return (simCmd.count >= SIM_UART_FIFO_SIZE) ? UART_Cmd_TX_STS_FIFO_FULL : 0u;
+}
+
+void SimUartCmdSetPendingTxInt(void)
+{
+    simIsrPending[SIM_ISR_CMD_TX] = TRUE;
+    SimServiceInterrupts(); //taken at once unless masked
+}
+
+void UART_LR_Data_PutArray(const uint8 string[], uint8 byteCount)
+{
+    simSinkLRData.packets++;
+    for (uint8 i = 0; i < byteCount; i++) SimUartTxPut(&simLRData, string[i]);
+}
+
+uint8 UART_LR_Data_GetTxBufferSize(void)
+{
+    return SimUartTxSoftCount(&simLRData);
+}
+
+uint8 UART_LR_Cmd_1_ReadRxStatus(void) { return (0 < simLRCmd[0].count) ? UART_LR_Cmd_1_RX_STS_FIFO_NOTEMPTY : 0u; }
+uint8 UART_LR_Cmd_1_ReadRxData(void) { return SimRxPop(&simLRCmd[0]); }
+uint8 UART_LR_Cmd_1_GetRxBufferSize(void) { return (uint8)MIN(255, simLRCmd[0].count); }
+uint8 UART_LR_Cmd_2_ReadRxStatus(void) { return (0 < simLRCmd[1].count) ? UART_LR_Cmd_2_RX_STS_FIFO_NOTEMPTY : 0u; }
+uint8 UART_LR_Cmd_2_ReadRxData(void) { return SimRxPop(&simLRCmd[1]); }
+uint8 UART_LR_Cmd_2_GetRxBufferSize(void) { return (uint8)MIN(255, simLRCmd[1].count); }
+
+uint32 SimLRCmdPush(uint8 port, const uint8 * data, uint32 len)
+{
+    if (1 < port) return 0;
+    return SimRxPush(&simLRCmd[port], data, len);
+}
+
+/* ---------------- USBUART_CD ---------------- */
+
+static uint8 simUsbConfigChanged = TRUE;
+static uint64_t simUsbBusyUntil = 0;
+
+uint8 USBUART_CD_GetConfiguration(void)
+{
+    return simUsbConnected;
+}
+
+uint8 USBUART_CD_IsConfigurationChanged(void)
+{
+    uint8 changed = simUsbConfigChanged && simUsbConnected;
+    if (changed) simUsbConfigChanged = FALSE;
+    return changed;
+}
+
+uint8 USBUART_CD_CDC_Init(void)
+{
+    return 1u;
+}
+
+uint8 USBUART_CD_CDCIsReady(void)
+{
+    return (simUsbBusyUntil <= simTimeNs) ? 1u : 0u;
+}
+
+void USBUART_CD_PutData(const uint8* pData, uint16 length)
+{
+    if (USBUART_BUFFER_SIZE < length) fprintf(stderr, "sim: USBUART_CD_PutData %u bytes, more than a full speed packet\n", length);
+    simSinkUSB.packets++;
+    for (uint16 i = 0; i < length; i++) SimSinkPut(&simSinkUSB, pData[i]);
+    simUsbBusyUntil = simTimeNs + simTiming.usbPacketNs;
+}
+
+uint8 USBUART_CD_DataIsReady(void)
+{
+    return (0 < simUsbRx.count) ? 1u : 0u;
+}
+
+uint16 USBUART_CD_GetAll(uint8* pData)
+{
+    uint16 n = 0;
+    while ((0 < simUsbRx.count) && (USBUART_BUFFER_SIZE > n)) pData[n++] = SimRxPop(&simUsbRx);
+    return n;
+}
+
+uint32 SimUsbRxPush(const uint8 * data, uint32 len)
+{
+    return SimRxPush(&simUsbRx, data, len);
+}
+
+/* ---------------- I2C_RTC ---------------- */
+
+static uint8 simI2CStatus = 0;
+static uint8 simI2CDoneStatus = 0;
+static uint64_t simI2CDone = SIM_TIME_NEVER;
+
+static void SimI2CStep(void)
+{
+    if ((0 != (simI2CStatus & I2C_RTC_MSTAT_XFER_INP)) && (simI2CDone <= simTimeNs))
+    {
+        simI2CStatus = (simI2CStatus & ~I2C_RTC_MSTAT_XFER_INP) | simI2CDoneStatus;
+        simI2CDone = SIM_TIME_NEVER;
+    }
+}
+
+uint8 I2C_RTC_MasterStatus(void)
+{
+    SimI2CStep();
+    return simI2CStatus;
+}
+
+uint8 I2C_RTC_MasterClearStatus(void)
+{
+    SimI2CStep();
+    uint8 status = simI2CStatus;
+    simI2CStatus &= I2C_RTC_MSTAT_XFER_INP;
+    return status;
+}
+
+uint8 I2C_RTC_MasterWriteBuf(uint8 slaveAddress, uint8 * wrData, uint8 cnt, uint8 mode)
+{
+    (void)slaveAddress; (void)wrData; (void)mode;
+    if (0 != (simI2CStatus & I2C_RTC_MSTAT_XFER_INP)) return 0x02u; //I2C_RTC_MSTR_BUS_BUSY
+    simStats.i2cTrans++;
+    simI2CStatus = I2C_RTC_MSTAT_XFER_INP;
+    simI2CDoneStatus = I2C_RTC_MSTAT_WR_CMPLT;
+    simI2CDone = simTimeNs + ((uint64_t)(cnt + 1) * simTiming.i2cByteNs);
+    return 0u;
+}
+
+uint8 I2C_RTC_MasterReadBuf(uint8 slaveAddress, uint8 * rdData, uint8 cnt, uint8 mode)
+{
+    (void)mode;
+    if (0 != (simI2CStatus & I2C_RTC_MSTAT_XFER_INP)) return 0x02u; //I2C_RTC_MSTR_BUS_BUSY
+    simStats.i2cTrans++;
+    for (uint8 i = 0; i < cnt; i++) rdData[i] = (uint8)(0x01u + i + (slaveAddress & 0x0F)); //small values are valid BCD for the RTC
+    simI2CStatus = I2C_RTC_MSTAT_XFER_INP;
+    simI2CDoneStatus = I2C_RTC_MSTAT_RD_CMPLT;
+    simI2CDone = simTimeNs + ((uint64_t)(cnt + 1) * simTiming.i2cByteNs);
+    return 0u;
+}
+
+/* ---------------- RTC_Main ---------------- */
+
+static RTC_Main_TIME_DATE simRTC = {0, 0, 0, 1, 1, 1, 1, 2020};
+static uint64_t simRTCNext = SIM_NS_PER_SEC;
+
+static void SimRTCTick(void)
+{
+    if (60 > ++simRTC.Sec) return;
+    simRTC.Sec = 0;
+    if (60 > ++simRTC.Min) return;
+    simRTC.Min = 0;
+    if (24 > ++simRTC.Hour) return;
+    simRTC.Hour = 0;
+    simRTC.DayOfYear++;
+    simRTC.DayOfWeek = (simRTC.DayOfWeek % 7) + 1;
+    if (28 < ++simRTC.DayOfMonth) //simple month, only used to keep the fields in range
+    {
+        simRTC.DayOfMonth = 1;
+        if (12 < ++simRTC.Month)
+        {
+            simRTC.Month = 1;
+            simRTC.DayOfYear = 1;
+            simRTC.Year++;
+        }
+    }
+}
+
+void RTC_Main_Start(void) {}
+void RTC_Main_Init(void) {}
+void RTC_Main_EnableInt(void) {}
+void RTC_Main_DisableInt(void) {}
+
+RTC_Main_TIME_DATE * RTC_Main_ReadTime(void)
+{
+    return &simRTC;
+}
+
+void RTC_Main_WriteTime(const RTC_Main_TIME_DATE * timeDate)
+{
+    memcpy(&simRTC, timeDate, sizeof(simRTC));
+}
+
+/* ---------------- barometer counters & die temperature ---------------- */
+
+#define SIM_BARO_COUNTERS (4u)
+static uint16 simBaroCnt[SIM_BARO_COUNTERS];
+static uint8 simBaroFifo[SIM_BARO_COUNTERS]; //captures waiting, capture value is the counter
+static uint64_t simBaroNext = SIM_TIME_NEVER;
+static const uint16 simBaroStep[SIM_BARO_COUNTERS] = {9000u, 11000u, 9100u, 11100u}; //counts per ISR period
+
+static void SimBaroStep(void)
+{
+    for (uint8 i = 0; i < SIM_BARO_COUNTERS; i++)
+    {
+        simBaroCnt[i] = (uint16)(((uint32)simBaroCnt[i] + simBaroStep[i]) % BARO_COUNT_MAX);
+        simBaroFifo[i] = 1;
+    }
+    simIsrPending[SIM_ISR_BARO] = TRUE;
+}
+
+static uint16 SimBaroRead(uint8 i)
+{
+    simBaroFifo[i] = 0;
+    return simBaroCnt[i];
+}
+
+uint8 Counter_BaroTemp1_ReadStatusRegister(void) { return simBaroFifo[0] ? Counter_BaroTemp1_STATUS_FIFONEMP : 0u; }
+uint8 Counter_BaroPres1_ReadStatusRegister(void) { return simBaroFifo[1] ? Counter_BaroPres1_STATUS_FIFONEMP : 0u; }
+uint8 Counter_BaroTemp2_ReadStatusRegister(void) { return simBaroFifo[2] ? Counter_BaroTemp2_STATUS_FIFONEMP : 0u; }
+uint8 Counter_BaroPres2_ReadStatusRegister(void) { return simBaroFifo[3] ? Counter_BaroPres2_STATUS_FIFONEMP : 0u; }
+uint16 Counter_BaroTemp1_ReadCapture(void) { return SimBaroRead(0); }
+uint16 Counter_BaroPres1_ReadCapture(void) { return SimBaroRead(1); }
+uint16 Counter_BaroTemp2_ReadCapture(void) { return SimBaroRead(2); }
+uint16 Counter_BaroPres2_ReadCapture(void) { return SimBaroRead(3); }
+
+cystatus DieTemp_Main_Start(void)
+{
+    return CYRET_SUCCESS;
+}
+
+cystatus DieTemp_Main_Query(int16 * temperature)
+{
+    *temperature = 25;
+    return CYRET_SUCCESS;
+}
+
+uint8 simEEPROM[2048];
+uint32 simEEPROMRows = 0; //row writes completed
+
+void CyEEPROM_Start(void) { }
+cystatus CySetTemp(void) { return CYRET_SUCCESS; }
+
+cystatus CyWriteRowData(uint8 arrayId, uint16 rowAddress, const uint8 * rowData)
+{
+    if ((CY_SPC_FIRST_EE_ARRAYID != arrayId) || (sizeof(simEEPROM) / CYDEV_EEPROM_ROW_SIZE <= rowAddress)) return CYRET_BAD_PARAM;
+    SimAdvance(SIM_EEPROM_ROW_NS); //SPC erase and program
+    memcpy(&simEEPROM[rowAddress * CYDEV_EEPROM_ROW_SIZE], rowData, CYDEV_EEPROM_ROW_SIZE);
+    simEEPROMRows++;
+    return CYRET_SUCCESS;
+}
+
+/* ---------------- interrupts & time ---------------- */
+
+void SimServiceInterrupts(void)
+{
+    uint8 guard = 16; //a level source the ISR does not drain would loop forever
+    if (simIntMask) return;
+    simIntMask = TRUE; //ISRs are not nested
+    uint8 again;
+    do {
+        again = FALSE;
+        if (0 < simSPISEv.count)
+        {
+            simStats.isrCalls[SIM_ISR_EV]++;
+            ISRReadEv();
+            again |= (0 < simSPISEv.count);
+        }
+        if (simIsrPending[SIM_ISR_SPI_RX])
+        {
+            simIsrPending[SIM_ISR_SPI_RX] = FALSE;
+            simStats.isrCalls[SIM_ISR_SPI_RX]++;
+            ISRReadSPI();
+        }
+        if (simIsrPending[SIM_ISR_SEL_LOW])
+        {
+            simIsrPending[SIM_ISR_SEL_LOW] = FALSE;
+            simStats.isrCalls[SIM_ISR_SEL_LOW]++;
+            ISRWriteSPI();
+        }
+        if (simIsrCmEnabled && ((0 < simLRCmd[0].count) || (0 < simLRCmd[1].count)))
+        {
+            simStats.isrCalls[SIM_ISR_CMD]++;
+            ISRCheckCmd();
+            again |= ((0 < simLRCmd[0].count) || (0 < simLRCmd[1].count));
+        }
+        if (simIsrPending[SIM_ISR_TICK])
+        {
+            simIsrPending[SIM_ISR_TICK] = FALSE;
+            simStats.isrCalls[SIM_ISR_TICK]++;
+            if (NULL != simSysTickCallback) simSysTickCallback();
+        }
+        if (simIsrPending[SIM_ISR_BARO])
+        {
+            simIsrPending[SIM_ISR_BARO] = FALSE;
+            simStats.isrCalls[SIM_ISR_BARO]++;
+            ISRBaroCap();
+        }
+        if (simIsrPending[SIM_ISR_CMD_TX])
+        {
+            simIsrPending[SIM_ISR_CMD_TX] = FALSE;
+            simStats.isrCalls[SIM_ISR_CMD_TX]++;
+            UART_Cmd_TXISR_ExitCallback(); //the component part has no bytes to move
+        }
+    } while (again && --guard);
+    simIntMask = FALSE;
+}
+
+static uint64_t SimNextEvent(uint64_t end)
+{
+    uint64_t next = end;
+    next = MIN(next, SimUartTxNext(&simHR));
+    next = MIN(next, SimUartTxNext(&simCmd));
+    next = MIN(next, SimUartTxNext(&simLRData));
+    next = MIN(next, simEvNext);
+    next = MIN(next, simSPIMBPDone);
+    next = MIN(next, simTimerSelLowExpire);
+    next = MIN(next, simSysTickNext);
+    next = MIN(next, simBaroNext);
+    next = MIN(next, simRTCNext);
+    next = MIN(next, simI2CDone);
+    return next;
+}
+
+static void SimStep(void)
+{
+    SimUartTxStep(&simHR);
+    SimUartTxStep(&simCmd);
+    SimUartTxStep(&simLRData);
+    if (simEvNext <= simTimeNs)
+    {
+        SimEvPush(simEvSrc + simEvSrcPos, 1);
+        simEvSrcPos++;
+        simEvNext = (simEvSrcPos < simEvSrcLen) ? (simEvNext + simTiming.evByteNs) : SIM_TIME_NEVER;
+    }
+    if (simSPIMBPDone <= simTimeNs)
+    {
+        simSPIMBPDone = SIM_TIME_NEVER;
+        if (sizeof(simSPIMBPRx) > simSPIMBPRxCount) simSPIMBPRx[simSPIMBPRxCount++] = simSPIMBPShift;
+        simSPIMBPTxStatus = SPIM_BP_STS_TX_FIFO_EMPTY;
+        simIsrPending[SIM_ISR_SPI_RX] = TRUE;
+    }
+    if (simTimerSelLowExpire <= simTimeNs)
+    {
+        simTimerSelLowExpire = SIM_TIME_NEVER; //one shot, stays enabled until stopped
+        simTimerSelLowStatus = 0x01u;
+        simIsrPending[SIM_ISR_SEL_LOW] = TRUE;
+    }
+    if (simSysTickNext <= simTimeNs)
+    {
+        simSysTickNext += SimSysTickNs();
+        simSysTickCountFlag = 1;
+        simIsrPending[SIM_ISR_TICK] = TRUE;
+    }
+    if (simBaroNext <= simTimeNs)
+    {
+        simBaroNext += simTiming.baroIsrNs;
+        SimBaroStep();
+    }
+    if (simRTCNext <= simTimeNs)
+    {
+        simRTCNext += SIM_NS_PER_SEC;
+        SimRTCTick();
+    }
+    SimI2CStep();
+    SimDmaService();
+}
+
+/**
+ * @brief Moves virtual time forward, running the peripherals and their interrupts
+ * @param ns time to advance in nanoseconds
+ */
+void SimAdvance(uint64_t ns)
+{
+    uint64_t end = simTimeNs + ns;
+    SimServiceInterrupts();
+    while (simTimeNs < end)
+    {
+        uint64_t next = SimNextEvent(end);
+        if (next > simTimeNs) simTimeNs = next;
+        SimStep();
+        SimServiceInterrupts();
+    }
+}
+
+/**
+ * @brief WFI, moves virtual time forward until an ISR runs
+ * @details Called with the interrupts masked, the ISR that wakes the CPU runs here instead of at
+ * CyExitCriticalSection, nothing runs in between. Without any interrupt source it returns at once.
+ */
+void SimWaitForInterrupt(void)
+{
+    uint64_t start = simTimeNs;
+    uint64_t calls = 0;
+    for (uint8 i = 0; i < SIM_ISR_NUM; i++) calls += simStats.isrCalls[i];
+    uint64_t now = calls;
+    uint8 mask = simIntMask;
+    simIntMask = FALSE;
+    while (now == calls)
+    {
+        uint64_t next = SimNextEvent(SIM_TIME_NEVER);
+        if (SIM_TIME_NEVER == next) break;
+        if (next > simTimeNs) simTimeNs = next;
+        SimStep();
+        SimServiceInterrupts();
+        now = 0;
+        for (uint8 i = 0; i < SIM_ISR_NUM; i++) now += simStats.isrCalls[i];
+    }
+    simIntMask = mask;
+    simStats.sleeps++;
+    simStats.sleepNs += simTimeNs - start;
+}
+
+/**
+ * @brief Check if all the output paths are drained
+ * @return uint8 TRUE when nothing is waiting in the UARTs or DMA
+ */
+uint8 SimOutputIdle(void)
+{
+    return (0 == simHR.count) && (0 == simCmd.count) && (0 == simLRData.count) && (!simChan[0].enabled);
+}
+
+void SimInit(void)
+{
+    if ((uintptr_t)buffFrameData > 0xFFFFFFFFu)
+    {
+        fprintf(stderr, "sim: static data above 4GB, build with -no-pie\n");
+        exit(2);
+    }
+    simTimeNs = 0;
+    memset(&simStats, 0, sizeof(simStats));
+    memset(simIsrPending, 0, sizeof(simIsrPending));
+    simSysTickNext = SIM_TIME_NEVER;
+    simSysTickCountFlag = 0;
+    simSysTickCallback = NULL;
+    simIsrCmEnabled = TRUE;
+    if (0 == simTiming.hrByteNs) simTiming.hrByteNs = SIM_UART_BYTE_NS(115200u); //V5.0 high rate baud
+    if (0 == simTiming.cmdByteNs) simTiming.cmdByteNs = SIM_UART_BYTE_NS(115200u);
+    if (0 == simTiming.lrDataByteNs) simTiming.lrDataByteNs = SIM_UART_BYTE_NS(19200u);
+    if (0 == simTiming.evByteNs) simTiming.evByteNs = 8000u; //1MHz SPI clock
+    if (0 == simTiming.usbPacketNs) simTiming.usbPacketNs = 125000u; //one bulk IN packet a microframe
+    if (0 == simTiming.bpByteNs) simTiming.bpByteNs = 8000u;
+    if (0 == simTiming.selLowNs) simTiming.selLowNs = 20000u;
+    if (0 == simTiming.baroIsrNs) simTiming.baroIsrNs = 250000000u; //4Hz
+    if (0 == simTiming.i2cByteNs) simTiming.i2cByteNs = 22500u; //400kHz
+    simHR.cap = SIM_UART_FIFO_SIZE;
+    simHR.byteNs = &simTiming.hrByteNs;
+    simHR.sink = &simSinkHR;
+    simCmd.cap = SIM_UART_FIFO_SIZE + SIM_UART_CMD_TX_BUFFER_SIZE;
+    simCmd.byteNs = &simTiming.cmdByteNs;
+    simCmd.sink = &simSinkCmd;
+    simCmd.txIsrPending = &simIsrPending[SIM_ISR_CMD_TX];
+    simLRData.cap = SIM_UART_FIFO_SIZE + SIM_UART_LR_DATA_TX_BUFFER_SIZE;
+    simLRData.byteNs = &simTiming.lrDataByteNs;
+    simLRData.sink = &simSinkLRData;
+    simSPISEv.cap = SIM_SPIS_EV_FIFO_SIZE;
+    simLRCmd[0].cap = simLRCmd[1].cap = SIM_UART_LR_CMD_RX_BUFFER_SIZE;
+    simUsbRx.cap = SIM_RX_BUFFER_SIZE;
+    simBaroNext = simTiming.baroIsrNs;
+    simRTCNext = SIM_NS_PER_SEC;
+    memset(simEEPROM, 0xFF, sizeof(simEEPROM)); //erased
+    simEEPROMRows = 0;
+}
+
+/* [] END OF FILE */
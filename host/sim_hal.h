@@ -0,0 +1,101 @@
+/* ========================================
+ *
+ * Brian Lucas
+ * Copyright Bartol Research Institute, 2020
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF Bartol Research Institute.
+ *
+ *
+ * Control side of the simulated hardware in sim_hal.c. The harness feeds the
+ * input sources, moves virtual time forward with SimAdvance() and reads back
+ * what the firmware sent out. Interrupts are raised by the simulated peripherals
+ * and serviced inside SimAdvance() between main loop passes, unless masked by
+ * CyEnterCriticalSection().
+ *
+ * ========================================
+*/
+
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+#include <stdio.h>
+#include "project.h"
+
+#define SIM_NS_PER_SEC (1000000000ull)
+#define SIM_UART_BYTE_NS(baud) ((uint32)((10ull * SIM_NS_PER_SEC) / (baud))) //8N1, 10 bits a byte
+#define SIM_EEPROM_ROW_NS (20000000u) //EEPROM row erase and program in CyWriteRowData, datasheet max
+
+#define SIM_SPIS_EV_FIFO_SIZE (4u) //hardware RX FIFO of SPIS_Ev
+#define SIM_UART_FIFO_SIZE (4u) //hardware TX FIFO of the UARTs
+#define SIM_UART_CMD_TX_BUFFER_SIZE (UART_Cmd_TX_BUFFER_SIZE) //software TX buffer of UART_Cmd
+#define SIM_UART_LR_DATA_TX_BUFFER_SIZE (259u) //software TX buffer of UART_LR_Data
+#define SIM_UART_LR_CMD_RX_BUFFER_SIZE (4u) //UART_LR_Cmd_x have no software RX buffer
+#define SIM_RX_BUFFER_SIZE (256u) //software RX buffer of UART_LR_Cmd_x and the USB OUT endpoint
+#define SIM_BP_LINES (7u) //backplane select lines
+#define SIM_BP_BOARD_BUFFER (4096u) //bytes a simulated backplane board can queue
+
+enum simBPLine {SIM_BP_SEL2_PWR, SIM_BP_SEL5_HV1, SIM_BP_SEL6_HV2, SIM_BP_SEL3_J16, SIM_BP_SEL12_J17, SIM_BP_SEL13_J18, SIM_BP_SEL7_J20};
+
+typedef struct SimSink {
+    FILE * file; //optional copy of every byte sent
+    uint8 * capture; //optional in memory copy, grown as needed
+    uint32 captureLen;
+    uint32 captureCap;
+    uint8 keepCapture;
+    uint64_t bytes;
+    uint64_t packets; //PutData / PutArray calls or DMA chains finished
+} SimSink;
+
+typedef struct SimTiming {
+    uint32 evByteNs; //spacing of Event PSOC bytes on SPIS_Ev, 0 is as fast as the FIFO drains
+    uint32 hrByteNs; //UART_HR_Data byte time
+    uint32 cmdByteNs; //UART_Cmd byte time
+    uint32 lrDataByteNs; //UART_LR_Data byte time
+    uint32 usbPacketNs; //time the CDC IN endpoint is busy after PutData
+    uint32 bpByteNs; //SPIM_BP byte transfer time
+    uint32 selLowNs; //Timer_SelLow period
+    uint32 baroIsrNs; //period of ISRBaroCap
+    uint32 i2cByteNs; //I2C_RTC byte time
+} SimTiming;
+
+enum simIsr {SIM_ISR_EV, SIM_ISR_SPI_RX, SIM_ISR_SEL_LOW, SIM_ISR_CMD, SIM_ISR_BARO, SIM_ISR_TICK, SIM_ISR_CMD_TX, SIM_ISR_NUM};
+
+typedef struct SimStats {
+    uint64_t evBytesIn; //bytes accepted by the SPIS_Ev FIFO
+    uint64_t evOverruns; //bytes lost because the FIFO was full
+    uint64_t isrCalls[SIM_ISR_NUM];
+    uint64_t dmaBytes;
+    uint64_t dmaTdDone;
+    uint32 resets; //CySoftwareReset calls
+    uint32 i2cTrans;
+    uint64_t sleeps; //WFI calls
+    uint64_t sleepNs; //virtual time spent in WFI
+} SimStats;
+
+extern uint64_t simTimeNs;
+extern SimTiming simTiming;
+extern SimStats simStats;
+extern SimSink simSinkHR;
+extern SimSink simSinkUSB;
+extern SimSink simSinkCmd;
+extern SimSink simSinkLRData;
+extern uint8 simUsbConnected;
+extern uint32 simEEPROMRows;
+
+void SimInit(void);
+void SimAdvance(uint64_t ns);
+void SimServiceInterrupts(void);
+void SimEvSetSource(const uint8 * data, uint32 len);
+uint32 SimEvSourceLeft(void);
+uint32 SimEvPush(const uint8 * data, uint32 len);
+uint32 SimBPQueue(uint8 line, const uint8 * data, uint32 len);
+uint32 SimLRCmdPush(uint8 port, const uint8 * data, uint32 len);
+uint32 SimUsbRxPush(const uint8 * data, uint32 len);
+uint8 SimOutputIdle(void);
+void SimSinkReset(SimSink * sink);
+
+#endif /* SIM_HAL_H */
+/* [] END OF FILE */